@@ -0,0 +1,974 @@
+/**
+ * @file main.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief micro and macro benchmarks of the conversion hot paths, on inputs
+ * built in memory so the numbers are reproducible.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <library/allocator/allocator.h>
+#include <library/containers/cvector.h>
+#include <library/streams/binary_stream.h>
+#include <library/string/cstring.h>
+#include <converter/allocators/arena.h>
+#include <converter/allocators/file_sink.h>
+#include <converter/allocators/pool.h>
+#include <converter/parsers/assimp/meshes.h>
+#include <converter/parsers/quake/bvh_utils.h>
+#include <converter/parsers/quake/topology/brush.h>
+#include <converter/parsers/quake/topology/poly_brush.h>
+#include <converter/parsers/quake/topology/polygon.h>
+#include <converter/thread_pool.h>
+#include <assimp/scene.h>
+#include <entity/mesh/mesh.h>
+#include <entity/scene/node.h>
+#include <entity/scene/scene.h>
+#include <entity/spatial/bvh.h>
+#include <loaders/loader_map.h>
+#include <math/face.h>
+#include <math/matrix4f.h>
+#include <math/vector3f.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+// allocation counting, both the global operator new and allocator_t calls.
+static std::atomic<uint64_t> s_allocations{0};
+
+void*
+operator new(size_t size)
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* block = malloc(size ? size : 1))
+    return block;
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void* block) noexcept
+{
+  free(block);
+}
+
+void
+operator delete(void* block, size_t) noexcept
+{
+  free(block);
+}
+
+// the allocator_t being measured, the counting allocator forwards to it.
+static allocator_t s_backing;
+
+static
+void*
+counting_allocate(size_t size)
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  return s_backing.mem_alloc(size);
+}
+
+static
+void*
+counting_container_allocate(size_t count, size_t elem_size)
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  return s_backing.mem_cont_alloc(count, elem_size);
+}
+
+static
+void*
+counting_reallocate(void* block, size_t size)
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  return s_backing.mem_realloc(block, size);
+}
+
+static
+void
+counting_free(void* block)
+{
+  s_backing.mem_free(block);
+}
+
+static
+void*
+malloc_allocate(size_t size)
+{
+  return malloc(size);
+}
+
+static
+void*
+malloc_container_allocate(size_t count, size_t elem_size)
+{
+  return calloc(count, elem_size);
+}
+
+static
+void*
+malloc_reallocate(void* block, size_t size)
+{
+  return realloc(block, size);
+}
+
+static
+void
+malloc_free(void* block)
+{
+  free(block);
+}
+
+static
+allocator_t
+make_counting_allocator()
+{
+  allocator_t allocator;
+  allocator.mem_alloc = counting_allocate;
+  allocator.mem_cont_alloc = counting_container_allocate;
+  allocator.mem_free = counting_free;
+  allocator.mem_alloc_alligned = nullptr;
+  allocator.mem_realloc = counting_reallocate;
+  return allocator;
+}
+
+enum class backing_t {
+  malloc,
+  arena,
+  pool
+};
+
+static const char* s_backing_names[] = { "malloc", "arena", "pool" };
+
+static
+void
+set_backing(backing_t backing)
+{
+  if (backing == backing_t::arena)
+    allocators::setup_arena_allocator(&s_backing);
+  else if (backing == backing_t::pool)
+    allocators::setup_pool_allocator(&s_backing);
+  else {
+    s_backing.mem_alloc = malloc_allocate;
+    s_backing.mem_cont_alloc = malloc_container_allocate;
+    s_backing.mem_free = malloc_free;
+    s_backing.mem_alloc_alligned = nullptr;
+    s_backing.mem_realloc = malloc_reallocate;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// harness, every iteration is timed on its own so the setup/teardown an
+// operation needs can be paused out of the measurement.
+using bench_clock_t = std::chrono::steady_clock;
+
+class state_t {
+public:
+  void
+  pause()
+  {
+    paused_at = bench_clock_t::now();
+    paused_allocations = s_allocations.load(std::memory_order_relaxed);
+  }
+
+  void
+  resume()
+  {
+    excluded += bench_clock_t::now() - paused_at;
+    excluded_allocations +=
+      s_allocations.load(std::memory_order_relaxed) - paused_allocations;
+  }
+
+  bench_clock_t::duration excluded{0};
+  uint64_t excluded_allocations = 0;
+
+private:
+  bench_clock_t::time_point paused_at;
+  uint64_t paused_allocations = 0;
+};
+
+struct case_t {
+  std::string name;
+  // work items per operation (brushes, triangles, vertices...).
+  uint64_t items;
+  std::function<void(state_t&)> operation;
+  backing_t backing = backing_t::malloc;
+};
+
+// results are accumulated here so the optimizer cannot drop the work.
+static volatile size_t s_sink;
+
+static
+void
+run_case(const case_t& bench, double min_seconds)
+{
+  set_backing(bench.backing);
+
+  // warm up, also faults in the memory.
+  state_t warmup;
+  bench.operation(warmup);
+
+  uint64_t iterations = 0;
+  uint64_t allocations = 0;
+  bench_clock_t::duration measured{0};
+  while (std::chrono::duration<double>(measured).count() < min_seconds) {
+    state_t state;
+    uint64_t allocations_before = s_allocations.load();
+    auto start = bench_clock_t::now();
+    bench.operation(state);
+    auto elapsed = bench_clock_t::now() - start;
+    measured += elapsed - state.excluded;
+    allocations +=
+      s_allocations.load() - allocations_before - state.excluded_allocations;
+    ++iterations;
+  }
+
+  double seconds = std::chrono::duration<double>(measured).count();
+  double ns_per_op = seconds * 1e9 / iterations;
+  double items_per_second = bench.items * iterations / seconds;
+  printf(
+    "%-40s %10llu %14.1f %14.0f %12.1f\n",
+    bench.name.c_str(),
+    (unsigned long long)iterations,
+    ns_per_op,
+    items_per_second,
+    (double)allocations / iterations);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// fixed inputs.
+static const char* s_texture = "bench";
+static const topology::texture_info_t s_texture_info = { 64, 64 };
+
+static
+topology::plane_t
+make_plane(const point3f& point, vector3f normal)
+{
+  normalize_set_v3f(&normal);
+
+  // any two tangents will do, the plane is defined by point and normal.
+  vector3f axis = fabs(normal.data[2]) < 0.9f ?
+    vector3f{ 0.f, 0.f, 1.f } : vector3f{ 1.f, 0.f, 0.f };
+  vector3f u = cross_product_v3f(&normal, &axis);
+  normalize_set_v3f(&u);
+  vector3f v = cross_product_v3f(&normal, &u);
+
+  topology::plane_t plane;
+  plane.face.points[0] = point;
+  plane.face.points[1] = add_v3f(&point, &u);
+  plane.face.points[2] = add_v3f(&point, &v);
+  plane.normal = normal;
+  plane.texture = s_texture;
+  plane.texture_info = s_texture_info;
+  return plane;
+}
+
+static
+topology::brush_t
+make_box_brush(const point3f& min, const point3f& max)
+{
+  std::vector<topology::plane_t> planes;
+  planes.push_back(make_plane(max, { 1.f, 0.f, 0.f }));
+  planes.push_back(make_plane(max, { 0.f, 1.f, 0.f }));
+  planes.push_back(make_plane(max, { 0.f, 0.f, 1.f }));
+  planes.push_back(make_plane(min, { -1.f, 0.f, 0.f }));
+  planes.push_back(make_plane(min, { 0.f, -1.f, 0.f }));
+  planes.push_back(make_plane(min, { 0.f, 0.f, -1.f }));
+  return topology::brush_t(std::move(planes));
+}
+
+// a prism with 'sides' faces around the z axis, capped top and bottom.
+static
+topology::brush_t
+make_cylinder_brush(uint32_t sides, float radius, float height)
+{
+  std::vector<topology::plane_t> planes;
+  for (uint32_t i = 0; i < sides; ++i) {
+    float angle = 2.f * K_PI * (i + 0.5f) / sides;
+    vector3f normal = { cosf(angle), sinf(angle), 0.f };
+    point3f point = { normal.data[0] * radius, normal.data[1] * radius, 0.f };
+    planes.push_back(make_plane(point, normal));
+  }
+  planes.push_back(make_plane({ 0.f, 0.f, height }, { 0.f, 0.f, 1.f }));
+  planes.push_back(make_plane({ 0.f, 0.f, 0.f }, { 0.f, 0.f, -1.f }));
+  return topology::brush_t(std::move(planes));
+}
+
+// a block on the xy plane whose top is a half circle vault of 'segments'
+// planes, its two end faces carry 'segments + 2' points.
+static
+topology::brush_t
+make_arch_brush(uint32_t segments, float radius, float depth)
+{
+  std::vector<topology::plane_t> planes;
+  for (uint32_t i = 0; i <= segments; ++i) {
+    float angle = K_PI * i / segments;
+    vector3f normal = { cosf(angle), 0.f, sinf(angle) };
+    point3f point = { normal.data[0] * radius, 0.f, normal.data[2] * radius };
+    planes.push_back(make_plane(point, normal));
+  }
+  planes.push_back(make_plane({ 0.f, depth, 0.f }, { 0.f, 1.f, 0.f }));
+  planes.push_back(make_plane({ 0.f, 0.f, 0.f }, { 0.f, -1.f, 0.f }));
+  planes.push_back(make_plane({ 0.f, 0.f, -radius }, { 0.f, 0.f, -1.f }));
+  return topology::brush_t(std::move(planes));
+}
+
+// a regular convex polygon on the xy plane, counter clockwise.
+static
+topology::polygon_t
+make_regular_polygon(uint32_t sides, float radius)
+{
+  topology::polygon_t polygon;
+  polygon.normal = { 0.f, 0.f, 1.f };
+  polygon.texture = s_texture;
+  polygon.texture_info = s_texture_info;
+  polygon.projection = topology::get_texture_projection(
+    polygon.texture_data, polygon.texture_info, polygon.normal);
+  for (uint32_t i = 0; i < sides; ++i) {
+    float angle = 2.f * K_PI * i / sides;
+    polygon.points.push_back(
+      { cosf(angle) * radius, sinf(angle) * radius, 0.f });
+  }
+  return polygon;
+}
+
+// adjacent boxes sharing faces, the typical input of the welding pass.
+static
+std::vector<topology::brush_t>
+make_box_grid(uint32_t x_count, uint32_t y_count, uint32_t z_count)
+{
+  const float size = 64.f;
+  std::vector<topology::brush_t> brushes;
+  for (uint32_t z = 0; z < z_count; ++z)
+    for (uint32_t y = 0; y < y_count; ++y)
+      for (uint32_t x = 0; x < x_count; ++x)
+        brushes.push_back(make_box_brush(
+          { x * size, y * size, z * size },
+          { (x + 1) * size, (y + 1) * size, (z + 1) * size }));
+  return brushes;
+}
+
+// a .map face through 3 integer points, wound the way the loader reads it so
+// the plane faces away from 'inside'.
+static
+loader_map_face_t
+make_map_face(
+  const int32_t* p0,
+  const int32_t* p1,
+  const int32_t* p2,
+  const int32_t* inside)
+{
+  int64_t a[3], b[3], c[3];
+  for (uint32_t k = 0; k < 3; ++k) {
+    a[k] = p2[k] - p0[k];
+    b[k] = p1[k] - p0[k];
+    c[k] = inside[k] - p0[k];
+  }
+  // the loader's normal is (p2 - p0) x (p1 - p0).
+  int64_t normal[3] = {
+    a[1] * b[2] - a[2] * b[1],
+    a[2] * b[0] - a[0] * b[2],
+    a[0] * b[1] - a[1] * b[0] };
+  bool flip = normal[0] * c[0] + normal[1] * c[1] + normal[2] * c[2] > 0;
+
+  loader_map_face_t face;
+  memset(&face, 0, sizeof(face));
+  strcpy(face.texture, s_texture);
+  face.scale[0] = face.scale[1] = 1.f;
+  for (uint32_t k = 0; k < 3; ++k) {
+    face.data[k] = p0[k];
+    face.data[3 + k] = flip ? p2[k] : p1[k];
+    face.data[6 + k] = flip ? p1[k] : p2[k];
+  }
+  return face;
+}
+
+// the brush of the .map faces, 'exact' false leaves out the exact planes the
+// loader attaches so the clip engine classifies in float.
+static
+topology::brush_t
+make_map_brush(std::vector<loader_map_face_t>& faces, bool exact)
+{
+  std::unordered_map<std::string, topology::texture_info_t> textures_info = {
+    { s_texture, s_texture_info } };
+  loader_map_brush_data_t data;
+  data.faces = faces.data();
+  data.face_count = (uint32_t)faces.size();
+  if (exact)
+    return topology::brush_t(&data, textures_info);
+
+  std::vector<topology::plane_t> planes;
+  for (auto& map_face : faces) {
+    const int32_t* p = map_face.data;
+    topology::plane_t plane;
+    // the loader's point order.
+    plane.face.points[0] = { (float)p[0], (float)p[1], (float)p[2] };
+    plane.face.points[1] = { (float)p[6], (float)p[7], (float)p[8] };
+    plane.face.points[2] = { (float)p[3], (float)p[4], (float)p[5] };
+    get_faces_normals(&plane.face, 1, &plane.normal);
+    plane.texture = s_texture;
+    plane.texture_info = s_texture_info;
+    planes.push_back(plane);
+  }
+  return topology::brush_t(std::move(planes));
+}
+
+// a convex ring extruded along 'extrusion' the way converter_fixtures writes
+// it, read through the .map brush constructor so it carries exact planes.
+static
+topology::brush_t
+make_map_prism(
+  std::vector<std::array<int32_t, 3>> ring,
+  const std::array<int32_t, 3>& extrusion)
+{
+  // drop the points merged by the integer rounding.
+  ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+  while (ring.size() > 1 && ring.front() == ring.back())
+    ring.pop_back();
+
+  std::array<int32_t, 3> inside = { 0, 0, 0 };
+  std::vector<std::array<int32_t, 3>> top;
+  for (auto& point : ring) {
+    std::array<int32_t, 3> raised;
+    for (uint32_t k = 0; k < 3; ++k) {
+      inside[k] += point[k];
+      raised[k] = point[k] + extrusion[k];
+    }
+    top.push_back(raised);
+  }
+  for (uint32_t k = 0; k < 3; ++k)
+    inside[k] = inside[k] / (int32_t)ring.size() + extrusion[k] / 2;
+
+  std::vector<loader_map_face_t> faces;
+  for (uint32_t i = 0, count = ring.size(); i < count; ++i) {
+    uint32_t next = (i + 1) % count;
+    faces.push_back(make_map_face(
+      ring[next].data(), ring[i].data(), top[next].data(), inside.data()));
+  }
+  faces.push_back(make_map_face(
+    ring[0].data(), ring[1].data(), ring[2].data(), inside.data()));
+  faces.push_back(make_map_face(
+    top[0].data(), top[2].data(), top[1].data(), inside.data()));
+  return make_map_brush(faces, true);
+}
+
+// the shapes converter_fixtures emits (boxes, wedges, cylinders and arch
+// segments) at a few heights and grid cells.
+static
+std::vector<topology::brush_t>
+make_fixture_brushes()
+{
+  std::vector<topology::brush_t> brushes;
+  for (int32_t cell = -3; cell <= 3; cell += 2) {
+    for (int32_t height = 32; height <= 144; height += 48) {
+      std::array<int32_t, 3> up = { 0, 0, height };
+      int32_t x = cell * 64, y = cell * 48;
+      brushes.push_back(make_map_prism(
+        { { x, y, 0 }, { x + 64, y, 0 }, { x + 64, y + 64, 0 },
+          { x, y + 64, 0 } }, up));
+      brushes.push_back(make_map_prism(
+        { { x, y, 0 }, { x + 64, y, 0 }, { x, y + 64, 0 } }, up));
+
+      for (uint32_t sides = 6; sides <= 32; sides += 2) {
+        std::vector<std::array<int32_t, 3>> ring;
+        for (uint32_t i = 0; i < sides; ++i) {
+          double angle = 2.0 * K_PI * (i + 0.5) / sides;
+          ring.push_back({
+            x + 64 + (int32_t)std::lround(cos(angle) * 64),
+            y + 64 + (int32_t)std::lround(sin(angle) * 64),
+            0 });
+        }
+        brushes.push_back(make_map_prism(ring, up));
+      }
+
+      // a half ring of segments standing on the xz plane, extruded along y.
+      const uint32_t segments = 12;
+      auto at = [&](int32_t radius, uint32_t i) {
+        double angle = K_PI * i / segments;
+        return std::array<int32_t, 3>{
+          x + 32 + (int32_t)std::lround(cos(angle) * radius), y,
+          (int32_t)std::lround(sin(angle) * radius) };
+      };
+      for (uint32_t i = 0; i < segments; ++i)
+        brushes.push_back(make_map_prism(
+          { at(24, i), at(32, i), at(32, i + 1), at(24, i + 1) },
+          { 0, 16, 0 }));
+    }
+  }
+  return brushes;
+}
+
+// a 'side' x 'side' vertices grid, two triangles per cell.
+static
+aiScene*
+make_grid_scene(uint32_t side)
+{
+  aiMesh* mesh = new aiMesh();
+  mesh->mNumVertices = side * side;
+  mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+  mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+  mesh->mTextureCoords[0] = new aiVector3D[mesh->mNumVertices];
+  mesh->mNumUVComponents[0] = 2;
+  for (uint32_t y = 0; y < side; ++y) {
+    for (uint32_t x = 0; x < side; ++x) {
+      uint32_t i = y * side + x;
+      float height = sinf(x * 0.3f) * cosf(y * 0.2f) * 4.f;
+      mesh->mVertices[i] = aiVector3D(x * 8.f, height, y * 8.f);
+      mesh->mNormals[i] = aiVector3D(0.f, 1.f, 0.f);
+      mesh->mTextureCoords[0][i] = aiVector3D(
+        x / (float)(side - 1), y / (float)(side - 1), 0.f);
+    }
+  }
+
+  mesh->mNumFaces = (side - 1) * (side - 1) * 2;
+  mesh->mFaces = new aiFace[mesh->mNumFaces];
+  for (uint32_t y = 0, f = 0; y + 1 < side; ++y) {
+    for (uint32_t x = 0; x + 1 < side; ++x) {
+      uint32_t i = y * side + x;
+      uint32_t quad[2][3] = {
+        { i, i + side, i + 1 }, { i + 1, i + side, i + side + 1 } };
+      for (auto& indices : quad) {
+        aiFace& face = mesh->mFaces[f++];
+        face.mNumIndices = 3;
+        face.mIndices = new unsigned int[3];
+        memcpy(face.mIndices, indices, sizeof(indices));
+      }
+    }
+  }
+
+  aiScene* scene = new aiScene();
+  scene->mNumMeshes = 1;
+  scene->mMeshes = new aiMesh*[1];
+  scene->mMeshes[0] = mesh;
+  return scene;
+}
+
+// populate_meshes leaves the node hierarchy to the caller, the bvh needs a
+// root referencing every mesh.
+static
+void
+add_root_node(scene_t* scene, const allocator_t* allocator)
+{
+  cvector_setup(&scene->node_repo, get_type_data(node_t), 4, allocator);
+  cvector_resize(&scene->node_repo, 1);
+  node_t *node = cvector_as(&scene->node_repo, 0, node_t);
+  node_def(node);
+  cstring_setup(&node->name, "", allocator);
+  cvector_setup(
+    &node->resources, get_type_data(node_resource_t), 0, allocator);
+  cvector_resize(&node->resources, scene->mesh_repo.size);
+  for (uint32_t i = 0; i < scene->mesh_repo.size; ++i) {
+    node_resource_t *resource = cvector_as(
+      &node->resources, i, node_resource_t);
+    resource->type_id = get_type_id(mesh_t);
+    resource->index = i;
+  }
+  cvector_setup(&node->nodes, get_type_data(uint32_t), 0, allocator);
+  matrix4f_set_identity(&node->transform);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static
+void
+add_topology_cases(std::vector<case_t>& cases)
+{
+  static const topology::brush_t box = make_box_brush(
+    { 0.f, 0.f, 0.f }, { 64.f, 64.f, 64.f });
+  static const topology::brush_t cylinder = make_cylinder_brush(
+    24, 128.f, 64.f);
+
+  cases.push_back({ "to_polygons/box", 6, [](state_t&) {
+    s_sink += box.to_polygons().size(); } });
+  cases.push_back({ "to_polygons/cylinder24", 26, [](state_t&) {
+    s_sink += cylinder.to_polygons().size(); } });
+  cases.push_back({ "to_polygons/box/mesh", 6, [](state_t&) {
+    s_sink += box.to_polygons(topology::polygon_engine_t::mesh).size(); } });
+  cases.push_back({ "to_polygons/cylinder24/mesh", 26, [](state_t&) {
+    s_sink += cylinder.to_polygons(
+      topology::polygon_engine_t::mesh).size(); } });
+
+  static const topology::polygon_t square = make_regular_polygon(4, 64.f);
+  static const topology::plane_t splitter = make_plane(
+    { 8.f, 0.f, 0.f }, { 1.f, 0.25f, 0.f });
+  cases.push_back({ "polygon_clip/split_quad", 1, [](state_t&) {
+    static topology::polygon_t front, back;
+    topology::edge_t edge;
+    square.clip(splitter, &front, &back, edge);
+    s_sink += front.points.size(); } });
+
+  // the clip engine stitches and sanitizes one face per plane, the caps and
+  // the vault ends are the largest polygons it produces.
+  static const topology::brush_t cylinder64 = make_cylinder_brush(
+    64, 256.f, 64.f);
+  static const topology::brush_t arch32 = make_arch_brush(32, 256.f, 64.f);
+  cases.push_back({ "to_polygons/cylinder64", 66, [](state_t&) {
+    s_sink += cylinder64.to_polygons().size(); } });
+  cases.push_back({ "to_polygons/arch32", 36, [](state_t&) {
+    s_sink += arch32.to_polygons().size(); } });
+  cases.push_back({ "to_polygons/cylinder64/mesh", 66, [](state_t&) {
+    s_sink += cylinder64.to_polygons(
+      topology::polygon_engine_t::mesh).size(); } });
+  cases.push_back({ "to_polygons/arch32/mesh", 36, [](state_t&) {
+    s_sink += arch32.to_polygons(
+      topology::polygon_engine_t::mesh).size(); } });
+
+  // the fixture shapes read as .map brushes, both engines on exact planes.
+  static const std::vector<topology::brush_t> fixtures = make_fixture_brushes();
+  cases.push_back({ "to_polygons/fixtures", fixtures.size(), [](state_t&) {
+    for (auto& brush : fixtures)
+      s_sink += brush.to_polygons().size(); } });
+  cases.push_back({ "to_polygons/fixtures/mesh", fixtures.size(),
+    [](state_t&) {
+      for (auto& brush : fixtures)
+        s_sink += brush.to_polygons(
+          topology::polygon_engine_t::mesh).size(); } });
+
+  // every point doubled and every edge split at its middle, sanitize has to
+  // drop 2 out of 3 points.
+  static const topology::polygon_t noisy_cap = [] {
+    topology::polygon_t cap = make_regular_polygon(64, 256.f);
+    topology::polygon_t noisy = cap;
+    noisy.points.clear();
+    for (uint32_t i = 0, count = cap.points.size(); i < count; ++i) {
+      const point3f& point = cap.points[i];
+      point3f middle = add_v3f(&point, &cap.points[(i + 1) % count]);
+      mult_set_v3f(&middle, 0.5f);
+      noisy.points.push_back(point);
+      noisy.points.push_back(point);
+      noisy.points.push_back(middle);
+    }
+    return noisy;
+  }();
+  cases.push_back({ "polygon_sanitize/cylinder64_cap", 192,
+    [](state_t& state) {
+      state.pause();
+      topology::polygon_t polygon = noisy_cap;
+      state.resume();
+      s_sink += polygon.sanitize();
+    } });
+
+  static const topology::polygon_t ngon = make_regular_polygon(16, 64.f);
+  cases.push_back({ "polygon_triangulate/16gon", 14, [](state_t&) {
+    s_sink += ngon.triangulate().size(); } });
+
+  // every box touches its neighbours, the whole grid is one welding group.
+  static thread_pool_t pool;
+  static std::vector<topology::poly_brush_t> prototypes[2];
+  static const uint32_t s_grid_sides[] = { 8, 32 };
+  for (uint32_t i = 0; i < 2; ++i) {
+    std::vector<topology::brush_t> grid = make_box_grid(
+      s_grid_sides[i], s_grid_sides[i], 4);
+    for (auto& brush : grid)
+      prototypes[i].emplace_back(&brush);
+  }
+
+  struct weld_case_t {
+    const char* name;
+    uint32_t prototype;
+    thread_pool_t* pool;
+  };
+  static const weld_case_t s_weld_cases[] = {
+    { "sort_and_weld/box_grid_8x8x4", 0, nullptr },
+    { "sort_and_weld/box_grid_32x32x4", 1, nullptr },
+    { "sort_and_weld/box_grid_32x32x4/pool", 1, &pool } };
+  for (const weld_case_t& weld : s_weld_cases) {
+    cases.push_back({ weld.name, prototypes[weld.prototype].size(),
+      [&weld](state_t& state) {
+        state.pause();
+        std::vector<topology::poly_brush_t> brushes =
+          prototypes[weld.prototype];
+        state.resume();
+        topology::poly_brush_t::sort_and_weld(brushes, weld.pool);
+        state.pause();
+        s_sink += brushes.size();
+        brushes.clear();
+        state.resume();
+      } });
+  }
+}
+
+static
+void
+add_scene_cases(std::vector<case_t>& cases)
+{
+  static const uint32_t s_side = 128;
+  static const uint64_t s_vertices = s_side * s_side;
+  static const uint64_t s_triangles = (s_side - 1) * (s_side - 1) * 2;
+  static aiScene* ai_scene = make_grid_scene(s_side);
+  static allocator_t counting = make_counting_allocator();
+
+  for (backing_t backing : {
+    backing_t::malloc, backing_t::arena, backing_t::pool }) {
+    std::string suffix = std::string("/") + s_backing_names[(int)backing];
+
+    case_t populate;
+    populate.name = "populate_meshes/grid128" + suffix;
+    populate.items = s_vertices;
+    populate.backing = backing;
+    populate.operation = [backing](state_t& state) {
+      scene_t* scene = scene_create(NULL, &counting);
+      populate_meshes(scene, ai_scene, &counting);
+      state.pause();
+      s_sink += scene->mesh_repo.size;
+      if (backing == backing_t::arena)
+        allocators::arena_reset();
+      else
+        scene_free(scene, &counting);
+      state.resume();
+    };
+    cases.push_back(populate);
+
+    case_t serialize;
+    serialize.name = "scene_serialize/grid128" + suffix;
+    serialize.items = s_vertices;
+    serialize.backing = backing;
+    serialize.operation = [backing](state_t& state) {
+      state.pause();
+      scene_t* scene = scene_create(NULL, &counting);
+      populate_meshes(scene, ai_scene, &counting);
+      add_root_node(scene, &counting);
+      state.resume();
+      binary_stream_t stream;
+      binary_stream_def(&stream);
+      binary_stream_setup(&stream, &counting);
+      scene_serialize(scene, &stream);
+      s_sink += stream.data->size;
+      if (backing != backing_t::arena)
+        binary_stream_cleanup(&stream);
+      state.pause();
+      if (backing == backing_t::arena)
+        allocators::arena_reset();
+      else
+        scene_free(scene, &counting);
+      state.resume();
+    };
+    cases.push_back(serialize);
+  }
+
+  // the loaders' path, the stream buffer is the mapped output file.
+  case_t sink;
+  sink.name = "scene_serialize/grid128/file_sink";
+  sink.items = s_vertices;
+  sink.operation = [](state_t& state) {
+    static const std::string path =
+      (std::filesystem::temp_directory_path() / "converter_bench.bin").string();
+    state.pause();
+    scene_t* scene = scene_create(NULL, &counting);
+    populate_meshes(scene, ai_scene, &counting);
+    add_root_node(scene, &counting);
+    state.resume();
+    allocator_t allocator;
+    allocators::file_sink_begin(path, &allocator);
+    binary_stream_t stream;
+    binary_stream_def(&stream);
+    binary_stream_setup(&stream, &allocator);
+    scene_serialize(scene, &stream);
+    s_sink += stream.data->size;
+    allocators::file_sink_end(
+      stream.data->data, stream.data->elem_data.size * stream.data->size);
+    binary_stream_cleanup(&stream);
+    state.pause();
+    scene_free(scene, &counting);
+    state.resume();
+  };
+  cases.push_back(sink);
+
+  // NOTE: the bvh has no free function of its own, it is built on the arena
+  // and dropped with a reset. The input scene lives in malloc memory.
+  static allocator_t heap;
+  heap.mem_alloc = malloc_allocate;
+  heap.mem_cont_alloc = malloc_container_allocate;
+  heap.mem_free = malloc_free;
+  heap.mem_alloc_alligned = nullptr;
+  heap.mem_realloc = malloc_reallocate;
+  static scene_t* bvh_scene = nullptr;
+  bvh_scene = scene_create(NULL, &heap);
+  populate_meshes(bvh_scene, ai_scene, &heap);
+  add_root_node(bvh_scene, &heap);
+
+  case_t bvh;
+  bvh.name = "create_bvh_from_scene/grid128";
+  bvh.items = s_triangles;
+  bvh.backing = backing_t::arena;
+  bvh.operation = [](state_t& state) {
+    bvh_t* result = create_bvh_from_scene(bvh_scene, &counting);
+    state.pause();
+    s_sink += result->nodes.size;
+    allocators::arena_reset();
+    state.resume();
+  };
+  cases.push_back(bvh);
+}
+
+// the engines may start a polygon at a different vertex, the points have to
+// match up to a rotation.
+static
+bool
+same_polygons(
+  const std::vector<topology::polygon_t>& lhs,
+  const std::vector<topology::polygon_t>& rhs)
+{
+  if (lhs.size() != rhs.size())
+    return false;
+
+  for (uint32_t i = 0; i < lhs.size(); ++i) {
+    const auto& a = lhs[i].points;
+    const auto& b = rhs[i].points;
+    if (a.size() != b.size())
+      return false;
+
+    bool found = false;
+    for (uint32_t shift = 0; shift < a.size() && !found; ++shift) {
+      found = true;
+      for (uint32_t j = 0; j < a.size() && found; ++j)
+        found = topology::identical_points(a[j], b[(j + shift) % b.size()]);
+    }
+    if (!found)
+      return false;
+  }
+  return true;
+}
+
+static
+uint32_t
+count_engine_mismatches(const std::vector<topology::brush_t>& brushes)
+{
+  uint32_t mismatches = 0;
+  for (auto& brush : brushes)
+    mismatches += !same_polygons(
+      brush.to_polygons(topology::polygon_engine_t::clip),
+      brush.to_polygons(topology::polygon_engine_t::mesh));
+  return mismatches;
+}
+
+// both engines on float brushes and on the exact brushes of the fixtures.
+static
+uint32_t
+check_polygon_engines()
+{
+  std::vector<topology::brush_t> brushes = make_box_grid(4, 4, 1);
+  for (uint32_t sides = 6; sides <= 32; sides += 2)
+    brushes.push_back(make_cylinder_brush(sides, 128.f, 64.f));
+  std::vector<topology::brush_t> fixtures = make_fixture_brushes();
+
+  uint32_t mismatches = count_engine_mismatches(brushes);
+  uint32_t fixture_mismatches = count_engine_mismatches(fixtures);
+  printf(
+    "to_polygons engines: %u of %zu float brushes differ, "
+    "%u of %zu fixture brushes\n\n",
+    mismatches, brushes.size(), fixture_mismatches, fixtures.size());
+  return mismatches + fixture_mismatches;
+}
+
+// pyramids whose 4 sides meet at an apex off the grid origin, the float
+// classification of the apex splits a sliver off the sides. Returns how many
+// brushes have a face with more points than it should.
+static
+uint32_t
+count_sliver_brushes(bool exact, uint32_t* brush_count)
+{
+  static const int32_t s_base[4][2] = {
+    { -11, -5 }, { 7, -9 }, { 5, 6 }, { -2, 8 } };
+  uint32_t slivers = 0;
+  *brush_count = 0;
+  for (int32_t x = -3000; x <= 3000; x += 997) {
+    for (int32_t y = -2000; y <= 2000; y += 1331) {
+      for (int32_t height = 7; height < 400; height += 61) {
+        int32_t apex[3] = { x, y, 17 + height };
+        int32_t inside[3] = { x, y, 18 };
+        int32_t corners[4][3];
+        for (uint32_t i = 0; i < 4; ++i) {
+          corners[i][0] = x + s_base[i][0];
+          corners[i][1] = y + s_base[i][1];
+          corners[i][2] = 17;
+        }
+
+        std::vector<loader_map_face_t> faces;
+        faces.push_back(
+          make_map_face(corners[0], corners[1], corners[2], inside));
+        for (uint32_t i = 0; i < 4; ++i)
+          faces.push_back(
+            make_map_face(apex, corners[i], corners[(i + 1) % 4], inside));
+
+        auto polygons = make_map_brush(faces, exact).to_polygons();
+        bool sliver = polygons.size() != 5;
+        for (uint32_t i = 0; i < polygons.size() && !sliver; ++i)
+          sliver = polygons[i].points.size() != (i ? 3 : 4);
+        slivers += sliver;
+        ++*brush_count;
+      }
+    }
+  }
+  return slivers;
+}
+
+// the default engine classifies with the exact planes of a .map brush.
+static
+uint32_t
+check_exact_clip()
+{
+  uint32_t brush_count = 0;
+  uint32_t exact = count_sliver_brushes(true, &brush_count);
+  uint32_t inexact = count_sliver_brushes(false, &brush_count);
+  printf(
+    "to_polygons slivers: %u of %u pyramids exact, %u in float\n\n",
+    exact, brush_count, inexact);
+  return exact;
+}
+
+// converter_bench [filter] [--min-time <seconds>] | --check
+// runs every case whose name contains 'filter', '--check' only runs the
+// checks and fails if any of them does.
+int main(int argc, char *argv[])
+{
+  std::string filter;
+  double min_seconds = 0.5;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--check")) {
+      uint32_t failures = check_polygon_engines();
+      failures += check_exact_clip();
+      return failures ? 1 : 0;
+    }
+    else if (!strcmp(argv[i], "--min-time") && i + 1 < argc)
+      min_seconds = atof(argv[++i]);
+    else
+      filter = argv[i];
+  }
+
+  std::vector<case_t> cases;
+  add_topology_cases(cases);
+  add_scene_cases(cases);
+
+  for (auto& bench : cases) {
+    if (
+      bench.name.find("to_polygons") == 0 &&
+      bench.name.find(filter) != std::string::npos) {
+      check_polygon_engines();
+      break;
+    }
+  }
+
+  printf(
+    "%-40s %10s %14s %14s %12s\n",
+    "case", "iterations", "ns/op", "items/s", "allocs/op");
+  for (auto& bench : cases)
+    if (bench.name.find(filter) != std::string::npos)
+      run_case(bench, min_seconds);
+
+  return 0;
+}
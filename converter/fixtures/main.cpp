@@ -0,0 +1,618 @@
+/**
+ * @file main.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief synthetic conversion inputs for scaling tests: quake maps with N
+ * brushes and a matching wad, obj meshes and skinned smd meshes with M
+ * vertices. Standalone, no dependency on the converter libraries.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+struct settings_t {
+  std::string output;
+  std::string name = "synthetic";
+  std::vector<uint32_t> brushes = { 256 };
+  std::string shape = "box";
+  // cylinder sides, arch segments.
+  uint32_t sides = 12;
+  // space between neighbouring brushes, 0 makes them share faces.
+  int32_t gap = 0;
+  uint32_t textures = 8;
+  std::vector<uint32_t> vertices = { 4096 };
+  uint32_t bones = 8;
+  uint32_t keys = 30;
+  uint32_t seed = 1;
+};
+
+struct ipoint_t {
+  int32_t x, y, z;
+};
+
+static
+ipoint_t
+operator+(const ipoint_t& a, const ipoint_t& b)
+{
+  return { a.x + b.x, a.y + b.y, a.z + b.z };
+}
+
+static
+ipoint_t
+operator-(const ipoint_t& a, const ipoint_t& b)
+{
+  return { a.x - b.x, a.y - b.y, a.z - b.z };
+}
+
+static
+int64_t
+dot(const ipoint_t& a, const ipoint_t& b)
+{
+  return (int64_t)a.x * b.x + (int64_t)a.y * b.y + (int64_t)a.z * b.z;
+}
+
+static
+ipoint_t
+cross(const ipoint_t& a, const ipoint_t& b)
+{
+  return {
+    a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+// NOTE: std distributions differ between standard libraries, the mapping from
+// the engine output is done by hand so a seed produces the same files
+// everywhere.
+class random_t {
+public:
+  explicit random_t(uint32_t seed) : engine(seed) {}
+
+  uint32_t
+  next(uint32_t count)
+  {
+    return (uint32_t)(engine() % count);
+  }
+
+private:
+  std::mt19937 engine;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// quake map.
+struct brush_writer_t {
+  std::ostringstream& out;
+  const std::vector<std::string>& textures;
+  random_t& random;
+
+  void
+  plane(const ipoint_t& p0, const ipoint_t& p1, const ipoint_t& p2)
+  {
+    const std::string& texture = textures[random.next(textures.size())];
+    out <<
+      "( " << p0.x << " " << p0.y << " " << p0.z << " ) "
+      "( " << p1.x << " " << p1.y << " " << p1.z << " ) "
+      "( " << p2.x << " " << p2.y << " " << p2.z << " ) " <<
+      texture << " " << random.next(64) << " " << random.next(64) << " " <<
+      (random.next(4) * 90) << " 1 1\n";
+  }
+
+  // extrudes a convex ring along 'extrusion'. Quake computes the outward
+  // normal of a plane as (p0 - p1) x (p2 - p1), the points are ordered to
+  // match.
+  void
+  prism(std::vector<ipoint_t> ring, const ipoint_t& extrusion)
+  {
+    // drop the points merged by the integer rounding.
+    ring.erase(std::unique(ring.begin(), ring.end(),
+      [](const ipoint_t& a, const ipoint_t& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z; }), ring.end());
+    while (
+      ring.size() > 1 &&
+      !dot(ring.front() - ring.back(), ring.front() - ring.back()))
+      ring.pop_back();
+    assert(ring.size() >= 3);
+
+    // the ring must turn counter clockwise around the extrusion.
+    if (dot(cross(ring[1] - ring[0], ring[2] - ring[1]), extrusion) < 0)
+      std::reverse(ring.begin(), ring.end());
+
+    out << "{\n";
+    for (size_t i = 0, count = ring.size(); i < count; ++i) {
+      const ipoint_t& a = ring[i];
+      const ipoint_t& b = ring[(i + 1) % count];
+      plane(b, a, b + extrusion);
+    }
+    plane(ring[0], ring[1], ring[2]);
+    plane(ring[0] + extrusion, ring[2] + extrusion, ring[1] + extrusion);
+    out << "}\n";
+  }
+};
+
+// a ring of 'sides' points around 'center' on the xy plane.
+static
+std::vector<ipoint_t>
+make_ring(const ipoint_t& center, int32_t radius, uint32_t sides)
+{
+  std::vector<ipoint_t> ring;
+  for (uint32_t i = 0; i < sides; ++i) {
+    double angle = 2.0 * M_PI * (i + 0.5) / sides;
+    ring.push_back({
+      center.x + (int32_t)std::lround(cos(angle) * radius),
+      center.y + (int32_t)std::lround(sin(angle) * radius),
+      center.z });
+  }
+  return ring;
+}
+
+// emits the shape in the 'cell' sized cell at 'origin', returns the number of
+// brushes written.
+static
+uint32_t
+write_shape(
+  brush_writer_t& writer,
+  const std::string& shape,
+  const ipoint_t& origin,
+  int32_t cell,
+  const settings_t& settings,
+  uint32_t budget)
+{
+  int32_t height = 32 + 16 * (int32_t)writer.random.next(8);
+  ipoint_t up = { 0, 0, height };
+
+  if (shape == "box") {
+    writer.prism({
+      origin,
+      origin + ipoint_t{ cell, 0, 0 },
+      origin + ipoint_t{ cell, cell, 0 },
+      origin + ipoint_t{ 0, cell, 0 } }, up);
+    return 1;
+  } else if (shape == "wedge") {
+    writer.prism({
+      origin,
+      origin + ipoint_t{ cell, 0, 0 },
+      origin + ipoint_t{ 0, cell, 0 } }, up);
+    return 1;
+  } else if (shape == "cylinder") {
+    ipoint_t center = origin + ipoint_t{ cell / 2, cell / 2, 0 };
+    writer.prism(make_ring(center, cell / 2, settings.sides), up);
+    return 1;
+  } else if (shape == "arch") {
+    // a half ring of segments standing on the xz plane, extruded along y.
+    uint32_t segments = std::min(settings.sides, budget);
+    int32_t outer = cell / 2;
+    int32_t inner = outer * 3 / 4;
+    ipoint_t center = origin + ipoint_t{ cell / 2, 0, 0 };
+    ipoint_t depth = { 0, std::max(cell / 4, 8), 0 };
+    auto at = [&](int32_t radius, uint32_t i) {
+      double angle = M_PI * i / segments;
+      return center + ipoint_t{
+        (int32_t)std::lround(cos(angle) * radius), 0,
+        (int32_t)std::lround(sin(angle) * radius) };
+    };
+    for (uint32_t i = 0; i < segments; ++i)
+      writer.prism(
+        { at(inner, i), at(outer, i), at(outer, i + 1), at(inner, i + 1) },
+        depth);
+    return segments;
+  }
+
+  assert(0 && "unknown shape!");
+  return budget;
+}
+
+static
+void
+write_map(
+  const std::filesystem::path& path,
+  const std::string& wad_name,
+  const std::vector<std::string>& textures,
+  uint32_t brush_count,
+  const settings_t& settings)
+{
+  static const char* s_shapes[] = { "box", "wedge", "cylinder", "arch" };
+  random_t random(settings.seed);
+  std::ostringstream out;
+  brush_writer_t writer = { out, textures, random };
+
+  out << "{\n\"classname\" \"worldspawn\"\n";
+  out << "\"wad\" \"" << wad_name << ".wad\"\n";
+
+  // brushes are laid on a square grid, one shape per cell.
+  const int32_t cell = settings.shape == "cylinder" ? 128 : 64;
+  const int32_t pitch = cell + settings.gap;
+  uint32_t side = (uint32_t)std::ceil(std::sqrt((double)brush_count));
+  uint32_t written = 0;
+  for (uint32_t i = 0; written < brush_count; ++i) {
+    ipoint_t origin = {
+      (int32_t)(i % side) * pitch - (int32_t)side * pitch / 2,
+      (int32_t)(i / side) * pitch - (int32_t)side * pitch / 2,
+      0 };
+    std::string shape = settings.shape;
+    if (shape == "mixed")
+      shape = s_shapes[random.next(4)];
+    written += write_shape(
+      writer, shape, origin, cell, settings, brush_count - written);
+  }
+  out << "}\n";
+
+  out << "{\n\"classname\" \"info_player_start\"\n";
+  out << "\"origin\" \"0 0 256\"\n\"angle\" \"90\"\n}\n";
+
+  // one light per 64 brushes, enough to exercise the light conversion.
+  for (uint32_t i = 0; i < std::max(1u, brush_count / 64); ++i) {
+    int32_t extent = (int32_t)side * pitch;
+    out << "{\n\"classname\" \"light\"\n";
+    out << "\"origin\" \"" <<
+      (int32_t)random.next(extent) - extent / 2 << " " <<
+      (int32_t)random.next(extent) - extent / 2 << " 192\"\n";
+    out << "\"light\" \"300\"\n}\n";
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  file << out.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// wad2, miptex lumps plus the palette.
+static
+void
+put_u32(std::vector<uint8_t>& buffer, uint32_t value)
+{
+  for (uint32_t i = 0; i < 4; ++i)
+    buffer.push_back((uint8_t)(value >> (i * 8)));
+}
+
+static
+void
+put_name(std::vector<uint8_t>& buffer, const std::string& name)
+{
+  char padded[16] = {};
+  strncpy(padded, name.c_str(), sizeof(padded) - 1);
+  buffer.insert(buffer.end(), padded, padded + sizeof(padded));
+}
+
+static
+void
+write_wad(
+  const std::filesystem::path& path,
+  const std::vector<std::string>& textures,
+  const settings_t& settings)
+{
+  struct lump_t {
+    uint32_t offset;
+    uint32_t size;
+    uint8_t type;
+    std::string name;
+  };
+
+  random_t random(settings.seed);
+  std::vector<uint8_t> data;
+  std::vector<lump_t> lumps;
+
+  // header, the directory offset is patched at the end.
+  data.insert(data.end(), { 'W', 'A', 'D', '2' });
+  put_u32(data, (uint32_t)textures.size() + 1);
+  put_u32(data, 0);
+
+  for (auto& name : textures) {
+    uint32_t width = 16u << random.next(4);
+    uint32_t height = 16u << random.next(4);
+    lump_t lump = { (uint32_t)data.size(), 0, 0x44, name };
+
+    put_name(data, name);
+    put_u32(data, width);
+    put_u32(data, height);
+    uint32_t offset = 40;
+    for (uint32_t mip = 0; mip < 4; ++mip) {
+      put_u32(data, offset);
+      offset += (width >> mip) * (height >> mip);
+    }
+
+    // a two color checker, the indices stay clear of the fullbright range.
+    uint8_t colors[2] = {
+      (uint8_t)random.next(224), (uint8_t)random.next(224) };
+    for (uint32_t mip = 0; mip < 4; ++mip)
+      for (uint32_t y = 0; y < (height >> mip); ++y)
+        for (uint32_t x = 0; x < (width >> mip); ++x)
+          data.push_back(colors[((x >> (3 - mip)) ^ (y >> (3 - mip))) & 1]);
+
+    lump.size = (uint32_t)data.size() - lump.offset;
+    lumps.push_back(lump);
+  }
+
+  {
+    lump_t lump = { (uint32_t)data.size(), 768, 0x40, "PALETTE" };
+    for (uint32_t i = 0; i < 256; ++i) {
+      data.push_back((uint8_t)i);
+      data.push_back((uint8_t)(255 - i));
+      data.push_back((uint8_t)((i * 7) & 0xff));
+    }
+    lumps.push_back(lump);
+  }
+
+  uint32_t directory = (uint32_t)data.size();
+  memcpy(data.data() + 8, &directory, sizeof(directory));
+  for (auto& lump : lumps) {
+    put_u32(data, lump.offset);
+    put_u32(data, lump.size);
+    put_u32(data, lump.size);
+    data.push_back(lump.type);
+    data.push_back(0);
+    data.push_back(0);
+    data.push_back(0);
+    put_name(data, lump.name);
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  file.write((const char*)data.data(), data.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// meshes.
+static
+void
+write_obj(
+  const std::filesystem::path& path,
+  uint32_t vertex_count)
+{
+  uint32_t side = std::max(2u, (uint32_t)std::ceil(std::sqrt(vertex_count)));
+  std::ostringstream out;
+  out << "# synthetic grid, " << side * side << " vertices\n";
+  for (uint32_t y = 0; y < side; ++y)
+    for (uint32_t x = 0; x < side; ++x)
+      out << "v " << x * 4.f << " " <<
+        sinf(x * 0.3f) * cosf(y * 0.2f) * 4.f << " " << y * 4.f << "\n";
+  out << "vn 0 1 0\n";
+  for (uint32_t y = 0; y < side; ++y)
+    for (uint32_t x = 0; x < side; ++x)
+      out << "vt " << x / (float)(side - 1) << " " <<
+        y / (float)(side - 1) << "\n";
+
+  // obj indices are 1 based.
+  for (uint32_t y = 0; y + 1 < side; ++y) {
+    for (uint32_t x = 0; x + 1 < side; ++x) {
+      uint32_t i = y * side + x + 1;
+      uint32_t quad[4] = { i, i + side, i + side + 1, i + 1 };
+      out << "f " << quad[0] << "/" << quad[0] << "/1 " <<
+        quad[1] << "/" << quad[1] << "/1 " <<
+        quad[2] << "/" << quad[2] << "/1\n";
+      out << "f " << quad[0] << "/" << quad[0] << "/1 " <<
+        quad[2] << "/" << quad[2] << "/1 " <<
+        quad[3] << "/" << quad[3] << "/1\n";
+    }
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  file << out.str();
+}
+
+// a tube along y skinned to a chain of bones, every key bends the chain.
+static
+void
+write_smd(
+  const std::filesystem::path& path,
+  uint32_t vertex_count,
+  const settings_t& settings)
+{
+  const uint32_t segments = 16;
+  const uint32_t rings = std::max(2u, vertex_count / segments);
+  const uint32_t bones = std::max(1u, settings.bones);
+  const float length = 8.f * rings;
+  const float bone_length = length / bones;
+  const float radius = 8.f;
+
+  std::ostringstream out;
+  out << "version 1\nnodes\n";
+  for (uint32_t i = 0; i < bones; ++i)
+    out << i << " \"bone" << i << "\" " << (int32_t)i - 1 << "\n";
+  out << "end\nskeleton\n";
+  for (uint32_t key = 0; key < std::max(1u, settings.keys); ++key) {
+    float bend = 0.3f * sinf(2.f * (float)M_PI * key / settings.keys);
+    out << "time " << key << "\n";
+    for (uint32_t i = 0; i < bones; ++i)
+      out << i << " 0 " << (i ? bone_length : 0.f) << " 0 " <<
+        (i ? bend : 0.f) << " 0 0\n";
+  }
+  out << "end\ntriangles\n";
+
+  // the smd lists every triangle corner with its normal, uv and weights.
+  auto vertex = [&](uint32_t ring, uint32_t segment) {
+    float angle = 2.f * (float)M_PI * (segment % segments) / segments;
+    float y = length * ring / (rings - 1);
+    float bone = std::min(y / bone_length, (float)bones - 1.f);
+    uint32_t first = (uint32_t)bone;
+    uint32_t second = std::min(first + 1, bones - 1);
+    float weight = bone - first;
+    out << first << " " << cosf(angle) * radius << " " << y << " " <<
+      sinf(angle) * radius << " " << cosf(angle) << " 0 " << sinf(angle) <<
+      " " << (float)segment / segments << " " << (float)ring / (rings - 1);
+    if (second != first)
+      out << " 2 " << first << " " << 1.f - weight << " " << second << " " <<
+        weight << "\n";
+    else
+      out << " 1 " << first << " 1\n";
+  };
+
+  for (uint32_t ring = 0; ring + 1 < rings; ++ring) {
+    for (uint32_t segment = 0; segment < segments; ++segment) {
+      out << "synthetic.png\n";
+      vertex(ring, segment);
+      vertex(ring + 1, segment);
+      vertex(ring + 1, segment + 1);
+      out << "synthetic.png\n";
+      vertex(ring, segment);
+      vertex(ring + 1, segment + 1);
+      vertex(ring, segment + 1);
+    }
+  }
+  out << "end\n";
+
+  std::ofstream file(path, std::ios::binary);
+  file << out.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// false unless the whole of 'text' is a decimal number within [min, max].
+static
+bool
+parse_number(const char* text, int64_t min, int64_t max, int64_t& number)
+{
+  char* end = nullptr;
+  errno = 0;
+  long long value = strtoll(text, &end, 10);
+  if (end == text || *end || errno == ERANGE || value < min || value > max)
+    return false;
+  number = value;
+  return true;
+}
+
+static
+bool
+parse_number(const char* text, uint32_t min, uint32_t& number)
+{
+  int64_t value;
+  if (!parse_number(text, min, UINT32_MAX, value))
+    return false;
+  number = (uint32_t)value;
+  return true;
+}
+
+static
+bool
+parse_counts(const char* text, std::vector<uint32_t>& counts)
+{
+  counts.clear();
+  std::stringstream stream(text);
+  std::string token;
+  while (std::getline(stream, token, ',')) {
+    uint32_t count;
+    if (token.size() && !parse_number(token.c_str(), 0, count))
+      return false;
+    if (token.size())
+      counts.push_back(count);
+  }
+  return counts.size();
+}
+
+static
+void
+print_usage()
+{
+  printf(
+    "usage: converter_fixtures <output_dir> [options]\n"
+    "options: --name <prefix>, file name prefix (synthetic).\n"
+    "         --brushes <n[,n...]>, one map per count (256).\n"
+    "         --shape <box|wedge|cylinder|arch|mixed>, brush shape (box).\n"
+    "         --sides <n>, cylinder sides and arch segments (12).\n"
+    "         --gap <units>, space between brushes, 0 shares faces (0).\n"
+    "         --textures <n>, textures in the wad (8).\n"
+    "         --vertices <m[,m...]>, one obj and one smd per count (4096).\n"
+    "         --bones <n>, --keys <n>, smd skeleton and animation (8, 30).\n"
+    "         --seed <n>, the output only depends on the seed (1).\n"
+    "pass a count of 0 to skip the maps or the meshes.\n");
+}
+
+// converter_fixtures <output_dir> [options], see print_usage().
+int main(int argc, char *argv[])
+{
+  if (argc < 2 || argv[1][0] == '-') {
+    print_usage();
+    return 1;
+  }
+
+  settings_t settings;
+  settings.output = argv[1];
+  for (int i = 2; i < argc; i += 2) {
+    const char* option = argv[i];
+    if (!strcmp(option, "--help") || !strcmp(option, "-h")) {
+      print_usage();
+      return 1;
+    }
+
+    if (i + 1 >= argc) {
+      printf("option '%s' is missing its value.\n", option);
+      print_usage();
+      return 1;
+    }
+
+    const char* value = argv[i + 1];
+    int64_t gap = 0;
+    bool valid = true;
+    if (!strcmp(option, "--name"))
+      settings.name = value;
+    else if (!strcmp(option, "--brushes"))
+      valid = parse_counts(value, settings.brushes);
+    else if (!strcmp(option, "--shape"))
+      settings.shape = value;
+    else if (!strcmp(option, "--sides"))
+      valid = parse_number(value, 3, settings.sides);
+    else if (!strcmp(option, "--gap")) {
+      valid = parse_number(value, INT32_MIN, INT32_MAX, gap);
+      settings.gap = (int32_t)gap;
+    } else if (!strcmp(option, "--textures"))
+      valid = parse_number(value, 1, settings.textures);
+    else if (!strcmp(option, "--vertices"))
+      valid = parse_counts(value, settings.vertices);
+    else if (!strcmp(option, "--bones"))
+      valid = parse_number(value, 0, settings.bones);
+    else if (!strcmp(option, "--keys"))
+      valid = parse_number(value, 1, settings.keys);
+    else if (!strcmp(option, "--seed"))
+      valid = parse_number(value, 0, settings.seed);
+    else
+      printf("unknown option '%s', ignored.\n", option);
+
+    if (!valid) {
+      printf("invalid value '%s' for option '%s'.\n", value, option);
+      print_usage();
+      return 1;
+    }
+  }
+
+  std::filesystem::path output = settings.output;
+  std::filesystem::create_directories(output);
+
+  std::vector<std::string> textures;
+  for (uint32_t i = 0; i < settings.textures; ++i)
+    textures.push_back("synth_" + std::to_string(i));
+
+  for (uint32_t count : settings.brushes) {
+    if (!count)
+      continue;
+
+    std::string base = settings.name + "_" + settings.shape + "_" +
+      std::to_string(count);
+    // every map gets its own wad so the maps can be converted in parallel.
+    write_wad(output / (base + ".wad"), textures, settings);
+    write_map(output / (base + ".map"), base, textures, count, settings);
+    printf("wrote '%s.map' and '%s.wad'\n", base.c_str(), base.c_str());
+  }
+
+  for (uint32_t count : settings.vertices) {
+    if (!count)
+      continue;
+
+    std::string base = settings.name + "_" + std::to_string(count);
+    write_obj(output / (base + ".obj"), count);
+    write_smd(output / (base + "_skinned.smd"), count, settings);
+    printf("wrote '%s.obj' and '%s_skinned.smd'\n", base.c_str(), base.c_str());
+  }
+
+  return 0;
+}
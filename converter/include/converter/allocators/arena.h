@@ -0,0 +1,47 @@
+/**
+ * @file arena.h
+ * @author khalilhenoud@gmail.com
+ * @brief bump allocator_t, frees are no-ops and everything is released at once
+ * with arena_reset(). Meant for scenes that are thrown away after serializing.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+typedef struct allocator_t allocator_t;
+
+namespace allocators {
+
+struct arena_stats_t {
+  // bytes handed out (headers and alignment padding included).
+  size_t used_bytes = 0;
+  // bytes obtained from the system.
+  size_t reserved_bytes = 0;
+  uint32_t chunks = 0;
+  uint64_t allocations = 0;
+  // reallocations of the last block that grew in place vs. were copied.
+  uint64_t grown_in_place = 0;
+  uint64_t moved = 0;
+};
+
+// NOTE: the arena is per thread, like the tracking allocator a conversion must
+// run start to finish on one thread.
+void
+setup_arena_allocator(allocator_t* allocator);
+
+// drops every block allocated on the calling thread, the largest chunk is kept
+// for the next conversion.
+void
+arena_reset();
+
+arena_stats_t
+arena_stats();
+
+}
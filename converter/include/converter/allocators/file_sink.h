@@ -0,0 +1,38 @@
+/**
+ * @file file_sink.h
+ * @author khalilhenoud@gmail.com
+ * @brief allocator_t for a binary_stream_t whose buffer lives in a memory mapped
+ * output file. Serializing writes straight into the file's pages, there is no
+ * in memory copy of the .bin and growing the buffer never copies it.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+
+typedef struct allocator_t allocator_t;
+
+namespace allocators {
+
+// opens (truncates) 'path' and fills 'allocator'. The first block the stream
+// reallocates becomes the mapped file, any other block is a plain heap block.
+// This relies on binary_stream_t growing its buffer through mem_realloc before
+// reallocating anything else, file_sink_end asserts it. A mapping that cannot
+// grow moves back to the heap and is written out by file_sink_end.
+// NOTE: one sink per thread, the stream must be used on the calling thread.
+bool
+file_sink_begin(const std::string& path, allocator_t* allocator);
+
+// completes the file with the stream's 'size' bytes at 'data', then unmaps and
+// truncates it. Call before cleaning up the stream, freeing the mapped block
+// afterwards is a no-op.
+bool
+file_sink_end(const void* data, size_t size);
+
+}
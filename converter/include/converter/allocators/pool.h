@@ -0,0 +1,52 @@
+/**
+ * @file pool.h
+ * @author khalilhenoud@gmail.com
+ * @brief thread safe allocator_t, size classes served from per thread caches
+ * refilled in batches from a shared pool. Accounting is per conversion and
+ * follows the block, so freeing on another thread is fine.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+typedef struct allocator_t allocator_t;
+
+namespace allocators {
+
+struct pool_account_t;
+
+struct pool_report_t {
+  size_t current_bytes = 0;
+  size_t peak_bytes = 0;
+  uint64_t allocations = 0;
+  uint64_t reallocations = 0;
+  uint64_t frees = 0;
+  // blocks still alive when the account was closed.
+  uint64_t leaked_blocks = 0;
+};
+
+void
+setup_pool_allocator(allocator_t* allocator);
+
+// opens a new account on the calling thread, every block allocated on it until
+// pool_end() is charged to that account. Blocks allocated without an account
+// are not reported.
+// NOTE: the parallel stages (brush conversion, weld) run on the worker threads
+// and use the std containers, their memory is not part of the report.
+void
+pool_begin();
+
+pool_report_t
+pool_end();
+
+void
+print_pool_report(const char* title, const pool_report_t& report);
+
+}
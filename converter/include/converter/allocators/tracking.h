@@ -0,0 +1,73 @@
+/**
+ * @file tracking.h
+ * @author khalilhenoud@gmail.com
+ * @brief malloc backed allocator_t that tracks every live block in a hash map
+ * (O(1) insert/erase) and accounts the bytes per tag.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+typedef struct allocator_t allocator_t;
+
+namespace allocators {
+
+struct tag_stats_t {
+  std::string tag;
+  size_t current_bytes = 0;
+  size_t peak_bytes = 0;
+  size_t total_bytes = 0;
+  uint64_t allocations = 0;
+};
+
+struct leak_t {
+  uintptr_t address;
+  size_t size;
+  std::string tag;
+};
+
+struct tracking_report_t {
+  size_t current_bytes = 0;
+  size_t peak_bytes = 0;
+  uint64_t allocations = 0;
+  uint64_t reallocations = 0;
+  uint64_t frees = 0;
+  std::vector<tag_stats_t> tags;
+  std::vector<leak_t> leaks;
+};
+
+// NOTE: the tracking state is per thread, a conversion runs start to finish on
+// the thread that started it.
+void
+setup_tracking_allocator(allocator_t* allocator);
+
+// clears the calling thread's state, call before a conversion.
+void
+tracking_begin();
+
+// returns the calling thread's report (the live blocks are reported as leaks)
+// and clears the state.
+tracking_report_t
+tracking_end();
+
+// the tag of a block is the innermost tag active when it was allocated, blocks
+// allocated outside of any scope are tagged 'untagged'.
+const char*
+set_tracking_tag(const char* tag);
+
+void
+print_tracking_report(
+  const char* title,
+  const tracking_report_t& report,
+  bool per_tag);
+
+}
@@ -0,0 +1,30 @@
+/**
+ * @file batch.h
+ * @author khalilhenoud@gmail.com
+ * @brief gathers the scene files of a batch conversion.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace Assimp { class Importer; }
+
+// .map files and any format the importer can read.
+bool
+is_scene_file(const Assimp::Importer& importer, const std::string& path);
+
+// 'source' is either a directory (searched recursively for .map files and any
+// format assimp can import) or a list file with one scene path per line. The
+// result is sorted by decreasing file size so the large scenes start first.
+// Scenes are converted into a folder named after the file, only the first of
+// the scenes sharing a name is kept, 'rejected' receives the number dropped.
+std::vector<std::string>
+collect_batch_jobs(const std::string& source, uint32_t* rejected = nullptr);
@@ -0,0 +1,52 @@
+/**
+ * @file cache.h
+ * @author khalilhenoud@gmail.com
+ * @brief content-hash conversion cache, a scene is only reconverted when its
+ * source, its dependencies, the import flags or the converter build change.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace cache {
+
+// 64 bits FNV-1a of the file content, 0 if the file cannot be read.
+uint64_t
+hash_file(const std::string& path);
+
+uint64_t
+combine(uint64_t seed, uint64_t value);
+
+// the key covers the scene file content, the import flags and the build.
+uint64_t
+make_key(
+  const std::string& scene_file,
+  uint64_t flags,
+  uint64_t build);
+
+// true if '<target_path>/<name>.bin' exists and the manifest next to it was
+// written with the same key, and every dependency it lists (textures, wad...)
+// still hashes to the recorded value.
+bool
+is_up_to_date(
+  const std::string& target_path,
+  const std::string& name,
+  uint64_t key);
+
+// writes the manifest, call once the conversion output is complete.
+void
+store(
+  const std::string& target_path,
+  const std::string& name,
+  uint64_t key,
+  const std::vector<std::string>& dependencies);
+
+}
@@ -0,0 +1,42 @@
+/**
+ * @file context.h
+ * @author khalilhenoud@gmail.com
+ * @brief per conversion settings, replaces the process wide folder globals.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+
+class thread_pool_t;
+struct wad_texture_cache_t;
+namespace Assimp { class Importer; }
+
+struct conversion_context_t {
+  // output root, every scene is written to 'data_folder + <scene name>'.
+  std::string data_folder;
+  // tools data, holds the quake palette.lmp used when a wad has none.
+  std::string tools_folder;
+  // skip scenes whose cache manifest is still valid.
+  bool use_cache = true;
+  // hash of the converter binary, part of every cache key.
+  uint64_t build_hash = 0;
+  // the allocator is an arena dropped after every conversion, walking the
+  // scene to free it block by block is wasted work.
+  bool single_shot_release = false;
+  // quake brushes are cut from a cube kept as a shared vertex mesh instead of
+  // clipping the cube's polygons one by one.
+  bool mesh_cutting = false;
+  // NOTE: shared worker pool, may be null in which case everything is serial.
+  thread_pool_t* pool = nullptr;
+  // NOTE: warm state reused across conversions, only valid when the scenes
+  // are converted one at a time (watch mode). Null means build per scene.
+  Assimp::Importer* importer = nullptr;
+  wad_texture_cache_t* wad_cache = nullptr;
+};
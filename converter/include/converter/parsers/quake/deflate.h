@@ -0,0 +1,26 @@
+/**
+ * @file deflate.h
+ * @author khalilhenoud@gmail.com
+ * @brief zlib stream compression for the png writer, lz77 over a 32KiB window
+ * with lazy matching, coded with per block dynamic huffman tables.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace deflate {
+
+// the zlib stream (rfc 1950, deflate rfc 1951) of the 'size' bytes at 'data'.
+// A block that does not compress is stored instead.
+std::vector<uint8_t>
+zlib_compress(const uint8_t* data, size_t size);
+
+}
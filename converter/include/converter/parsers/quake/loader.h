@@ -12,8 +12,11 @@
 
 
 typedef struct allocator_t allocator_t;
+struct conversion_context_t;
 
-void
+// false when the scene could not be read or its .bin could not be written.
+bool
 load_qmap(
   const char* scene_file, 
+  const conversion_context_t* context,
   const allocator_t* allocator);
\ No newline at end of file
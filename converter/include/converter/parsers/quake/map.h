@@ -17,11 +17,35 @@
 typedef struct allocator_t allocator_t;
 typedef struct scene_t scene_t;
 typedef struct loader_map_data_t loader_map_data_t;
-typedef std::vector<std::string> texture_vec_t;
+struct conversion_context_t;
+struct wad_texture_cache_t;
 
-texture_vec_t
+// keeps the wads mapped between conversions (watch mode).
+wad_texture_cache_t*
+create_wad_texture_cache();
+
+void
+free_wad_texture_cache(wad_texture_cache_t* cache);
+
+// the wad path is relative to the map file, without the '.wad' extension.
+std::string
+get_wad_directory(
+  const char* scene_file,
+  std::string wad_directory);
+
+std::string
+get_wad_file(
+  const char* scene_file,
+  std::string wad_directory);
+
+// the wad textures the map references are written as png files to
+// 'texture_directory', the rest of the wad is ignored. False when the wad
+// cannot be read or a texture cannot be written.
+bool
 map_to_bin(
   const char* scene_file,
   loader_map_data_t* map_data, 
   scene_t* scene,
+  const std::string& texture_directory,
+  const conversion_context_t* context,
   const allocator_t* allocator);
\ No newline at end of file
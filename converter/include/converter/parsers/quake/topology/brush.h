@@ -10,10 +10,8 @@
  */
 #pragma once
 
-#include <list>
 #include <vector>
 #include <string>
-#include <optional>
 #include <unordered_map>
 #include <converter/parsers/quake/topology/polygon.h>
 #include <converter/parsers/quake/topology/texture_data.h>
@@ -26,22 +24,53 @@ namespace topology {
 std::vector<polygon_t>
 make_cube(const float scale = 8192.f);
 
+// how a brush turns its planes into polygons. 'clip' cuts a large cube by every
+// plane and stitches each new face from the cut edges, 'mesh' cuts the same
+// cube kept as a mesh that shares its vertices, each vertex is classified once
+// per plane and the new face is chained through the vertex indices.
+enum class polygon_engine_t {
+  clip,
+  mesh
+};
+
 class brush_t {
 public:
   brush_t(
     const loader_map_brush_data_t* brush, 
-    std::unordered_map<std::string, texture_info_t>& textures_info);
+    const std::unordered_map<std::string, texture_info_t>& textures_info);
 
+  // planes are expected to face outward.
+  explicit brush_t(std::vector<plane_t> planes);
+
+  // one polygon per plane that bounds the brush, in plane order. 'open_faces'
+  // receives the number of faces whose edges did not close into a loop.
   std::vector<polygon_t>
-  to_polygons() const;
+  to_polygons(
+    polygon_engine_t engine = polygon_engine_t::clip,
+    uint32_t* open_faces = nullptr) const;
 
+  // connects the intersection edges into the face lying on 'plane', 'edges'
+  // is consumed. Returns false if they do not form a valid polygon, 'closed'
+  // is set to whether the chain got back to its first point before running
+  // out of edges (an open chain is still turned into a polygon). 'edge_planes'
+  // (consumed too) holds the exact plane each edge was cut from, the closed
+  // face of an exact 'plane' then carries the planes of its edges.
   static
-  std::optional<polygon_t>
+  bool
   make_face(
     const plane_t& plane,
-    const std::list<edge_t>& edge_list);
+    std::vector<edge_t>& edges,
+    polygon_t& polygon,
+    bool* closed = nullptr,
+    std::vector<const exact_plane_t*>* edge_planes = nullptr);
 
 private:
+  std::vector<polygon_t>
+  clip_polygons(uint32_t* open_faces) const;
+
+  std::vector<polygon_t>
+  cut_mesh_polygons(uint32_t* open_faces) const;
+
   std::vector<plane_t> planes;
 };
 
@@ -0,0 +1,68 @@
+/**
+ * @file exact.h
+ * @author khalilhenoud@gmail.com
+ * @brief exact orientation predicates for planes through integer points. Every
+ * predicate is first evaluated in double with an error bound, the exact
+ * (floating point expansion) evaluation only runs when the result is too close
+ * to zero to trust.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <math/vector3f.h>
+
+
+namespace topology {
+
+// normal . x = distance, with an integer normal and distance reduced by their
+// gcd. The values are held in doubles, they are exact as long as the points
+// stay within +-65536 (.map coordinates are well within that).
+struct exact_plane_t {
+  double normal[3] = { 0.0, 0.0, 0.0 };
+  double distance = 0.0;
+  bool valid = false;
+};
+
+// the plane through 3 integer points, oriented so its normal agrees with
+// 'normal' (the float normal computed for the same points).
+exact_plane_t
+make_exact_plane(
+  const int32_t* p0,
+  const int32_t* p1,
+  const int32_t* p2,
+  const vector3f& normal);
+
+// -1, 0 or 1, the sign of the plane equation at 'point'.
+int32_t
+orient_point(const exact_plane_t& plane, const point3f& point);
+
+// -1, 0 or 1, the sign of the determinant of the 3 normals. 0 means the planes
+// do not meet at a single point.
+int32_t
+orient_normals(
+  const exact_plane_t& plane0,
+  const exact_plane_t& plane1,
+  const exact_plane_t& plane2);
+
+// -1, 0 or 1, the sign of the plane equation at the point where plane0..2
+// meet. The 3 planes must meet at a single point.
+int32_t
+orient_vertex(
+  const exact_plane_t& plane,
+  const exact_plane_t& plane0,
+  const exact_plane_t& plane1,
+  const exact_plane_t& plane2);
+
+// the point where plane0..2 meet, rounded to float.
+point3f
+intersect_exact_planes(
+  const exact_plane_t& plane0,
+  const exact_plane_t& plane1,
+  const exact_plane_t& plane2);
+
+}
@@ -17,14 +17,36 @@ namespace topology {
 
 struct texture_data_t;
 struct texture_info_t;
+struct texture_projection_t;
 
-point3f
-get_texture_coordinates(
-  const point3f& point,
+texture_projection_t
+get_texture_projection(
   const texture_data_t& texture_data,
   const texture_info_t& texture_info,
   const vector3f& normal);
 
+// writes the texture coordinates of 'count' points to 'uvs'.
+void
+get_texture_coordinates(
+  const texture_projection_t& projection,
+  const point3f* points,
+  uint32_t count,
+  point3f* uvs);
+
+// spreads the coordinates of a uniform grid cell over a hash table, mask the
+// result with the (power of 2) table size. Brush points sit on power of 2
+// grids, so the high bits are folded into the low ones the mask keeps.
+inline
+uint32_t
+hash_cell(int32_t x, int32_t y, int32_t z)
+{
+  uint32_t hash = (uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^
+    (uint32_t)z * 83492791u;
+  hash ^= hash >> 16;
+  hash *= 0x45d9f3bu;
+  return hash ^ (hash >> 16);
+}
+
 inline
 float
 distance_points(const point3f& p1, const point3f& p2)
@@ -12,8 +12,11 @@
 
 #include <functional>
 #include <converter/parsers/quake/topology/brush.h>
+#include <converter/parsers/quake/topology/small_vector.h>
 
 
+class thread_pool_t;
+
 namespace topology {
 
 // poly_brush_t is optimized for welding, this would be useful when welding many
@@ -22,28 +25,39 @@ class poly_brush_t {
   static constexpr float s_value = 1.f/16.f;
 
 public:
-  poly_brush_t(const brush_t* brush, const float radius = s_value);
+  // an empty brush, a slot to move a converted brush into.
+  poly_brush_t() = default;
+  poly_brush_t(
+    const brush_t* brush,
+    const polygon_engine_t engine = polygon_engine_t::clip,
+    const float radius = s_value);
 
   std::vector<face_t>
   to_faces() const;
 
-  static
-  void
-  weld(
-    std::vector<poly_brush_t*>& brushes, 
-    const float radius = s_value);
+  // faces of the source brush whose edges did not close into a loop.
+  uint32_t
+  open_faces() const { return open_face_count; }
 
+  // welds every brush of a map in one pass. Points linked by a chain of points
+  // within 'radius' of each other form a group. In index order, each point of
+  // a group joins the first earlier seed within 'radius' of it or becomes a
+  // seed, and every cluster moves to its average. The result does not depend
+  // on the pool or the scheduling.
   static
   void
   sort_and_weld(
     std::vector<poly_brush_t>& brushes, 
+    thread_pool_t* pool = nullptr,
     const float radius = s_value);
 
 private:
+  // declared ahead of 'polygons', the constructor fills both at once.
+  uint32_t open_face_count = 0;
   std::vector<polygon_t> polygons;
   
   struct indexed_poly_t {
-    std::vector<uint32_t> indices;
+    small_vector_t<uint32_t, 16> indices;
   }; 
 
   struct weld_meta_t {
@@ -12,9 +12,10 @@
 
 #include <vector>
 #include <string>
-#include <memory>
 #include <converter/parsers/quake/topology/texture_data.h>
 #include <converter/parsers/quake/topology/edge.h>
+#include <converter/parsers/quake/topology/exact.h>
+#include <converter/parsers/quake/topology/small_vector.h>
 #include <math/vector3f.h>
 #include <collision/face.h>
 
@@ -30,20 +31,32 @@ struct face_t {
   point3f uv[3];
 };
 
-using plane_t = face_t;
+// a brush plane, 'exact' is only set when it was read from integer points.
+struct plane_t : face_t {
+  exact_plane_t exact;
+  texture_projection_t projection;
+};
 
 struct polygon_t {
 
-  struct clip_data_t {
-    std::shared_ptr<polygon_t> front = nullptr;
-    std::shared_ptr<polygon_t> back = nullptr;
-    std::shared_ptr<edge_t> edge = nullptr;
+  enum class side_t {
+    back,
+    front,
+    split
   };
 
-  // clips the poly against a plane of the brush and return clip data containing
-  // front and back splits and incident edge (whenever available)
-  clip_data_t
-  clip(const plane_t& plane) const;
+  // clips the poly against a plane of the brush. A poly that lies on one side
+  // (coplanar goes to the back) is left to the caller, nothing is written. On
+  // a split the front and back parts are written to 'front' and 'back' (either
+  // can be null to drop it) and the incident edge to 'edge'. The points are
+  // classified exactly when the poly and the plane both carry exact planes,
+  // the parts then carry them too.
+  side_t
+  clip(
+    const plane_t& plane,
+    polygon_t* front,
+    polygon_t* back,
+    edge_t& edge) const;
 
   std::vector<face_t>
   triangulate() const;
@@ -52,11 +65,19 @@ struct polygon_t {
   bool
   sanitize();
 
-  std::vector<point3f> points;
+  // brush polygons rarely go past 8 points, they stay inline.
+  small_vector_t<point3f, 16> points;
   vector3f normal;
   std::string texture;
   texture_data_t texture_data;
   texture_info_t texture_info;
+  // from the brush plane, the uvs of every point.
+  texture_projection_t projection;
+  // only while a brush is being cut from exact planes, null otherwise. The poly
+  // lies on 'exact_plane' and the edge out of points[i] on 'exact_edges[i]',
+  // every point is where its poly plane and its 2 edge planes meet.
+  const exact_plane_t* exact_plane = nullptr;
+  small_vector_t<const exact_plane_t*, 16> exact_edges;
 };
 
 }
\ No newline at end of file
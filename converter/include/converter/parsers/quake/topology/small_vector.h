@@ -0,0 +1,213 @@
+/**
+ * @file small_vector.h
+ * @author khalilhenoud@gmail.com
+ * @brief vector with inline storage for its first N elements, it only touches
+ * the heap once it outgrows them.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+
+namespace topology {
+
+// NOTE: limited to trivially copyable types (points, indices, enums), elements
+// are moved around with memcpy/memmove.
+template<typename T, uint32_t N>
+class small_vector_t {
+  static_assert(
+    std::is_trivially_copyable<T>::value,
+    "small_vector_t only holds trivially copyable types");
+
+public:
+  using value_type = T;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  small_vector_t() = default;
+
+  small_vector_t(const small_vector_t& rhs)
+  {
+    assign(rhs.begin(), rhs.end());
+  }
+
+  small_vector_t(small_vector_t&& rhs) noexcept
+  {
+    take(rhs);
+  }
+
+  ~small_vector_t()
+  {
+    release();
+  }
+
+  small_vector_t&
+  operator=(const small_vector_t& rhs)
+  {
+    if (this != &rhs)
+      assign(rhs.begin(), rhs.end());
+    return *this;
+  }
+
+  small_vector_t&
+  operator=(small_vector_t&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      release();
+      take(rhs);
+    }
+    return *this;
+  }
+
+  void
+  assign(const T* first, const T* last)
+  {
+    uint32_t size = (uint32_t)(last - first);
+    reserve(size);
+    if (size)
+      memmove(data(), first, size * sizeof(T));
+    count = size;
+  }
+
+  void
+  reserve(uint32_t size)
+  {
+    if (size <= capacity)
+      return;
+
+    T* block = (T*)::operator new(size * sizeof(T));
+    if (count)
+      memcpy(block, data(), count * sizeof(T));
+    release();
+    heap = block;
+    capacity = size;
+  }
+
+  void
+  resize(uint32_t size)
+  {
+    reserve(size);
+    for (uint32_t i = count; i < size; ++i)
+      data()[i] = T{};
+    count = size;
+  }
+
+  void
+  push_back(const T& value)
+  {
+    if (count == capacity) {
+      // 'value' may live in the storage being replaced.
+      T copy = value;
+      reserve(capacity * 2);
+      data()[count++] = copy;
+    } else
+      data()[count++] = value;
+  }
+
+  void
+  pop_back()
+  {
+    assert(count);
+    --count;
+  }
+
+  iterator
+  erase(const_iterator position)
+  {
+    T* at = data() + (position - data());
+    assert(at >= data() && at < end());
+    memmove(at, at + 1, (end() - at - 1) * sizeof(T));
+    --count;
+    return at;
+  }
+
+  void
+  clear() { count = 0; }
+
+  uint32_t
+  size() const { return count; }
+
+  bool
+  empty() const { return count == 0; }
+
+  T*
+  data() { return heap ? heap : items; }
+
+  const T*
+  data() const { return heap ? heap : items; }
+
+  T&
+  operator[](uint32_t index) { assert(index < count); return data()[index]; }
+
+  const T&
+  operator[](uint32_t index) const
+  {
+    assert(index < count);
+    return data()[index];
+  }
+
+  T&
+  front() { return (*this)[0]; }
+
+  const T&
+  front() const { return (*this)[0]; }
+
+  T&
+  back() { return (*this)[count - 1]; }
+
+  const T&
+  back() const { return (*this)[count - 1]; }
+
+  iterator
+  begin() { return data(); }
+
+  iterator
+  end() { return data() + count; }
+
+  const_iterator
+  begin() const { return data(); }
+
+  const_iterator
+  end() const { return data() + count; }
+
+private:
+  void
+  release()
+  {
+    if (heap)
+      ::operator delete(heap);
+    heap = nullptr;
+    capacity = N;
+  }
+
+  // 'rhs' is left empty, inline elements have to be copied.
+  void
+  take(small_vector_t& rhs)
+  {
+    if (rhs.heap) {
+      heap = rhs.heap;
+      capacity = rhs.capacity;
+    } else if (rhs.count)
+      memcpy(items, rhs.items, rhs.count * sizeof(T));
+    count = rhs.count;
+    rhs.heap = nullptr;
+    rhs.capacity = N;
+    rhs.count = 0;
+  }
+
+  T items[N];
+  T* heap = nullptr;
+  uint32_t count = 0;
+  uint32_t capacity = N;
+};
+
+}
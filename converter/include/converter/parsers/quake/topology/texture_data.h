@@ -24,4 +24,10 @@ struct texture_info_t {
   uint32_t height = 0;
 };
 
+// the STfromXYZ matrix of a plane, uv = (st[0] . (x, y, z, 1), st[1] . ...).
+// It only depends on the plane's texture data, texture info and normal.
+struct texture_projection_t {
+  float st[2][4] = { { 0.f, 0.f, 0.f, 0.f }, { 0.f, 0.f, 0.f, 0.f } };
+};
+
 }
\ No newline at end of file
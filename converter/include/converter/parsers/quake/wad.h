@@ -0,0 +1,76 @@
+/**
+ * @file wad.h
+ * @author khalilhenoud@gmail.com
+ * @brief WAD2 miptex reader, the file is memory mapped and only the lump headers
+ * are read until a texture's pixels are actually needed.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace wad {
+
+struct miptex_t {
+  // the lump name as stored in the wad, not sanitized.
+  std::string name;
+  uint32_t width;
+  uint32_t height;
+  // width * height palette indices of the first mip level, inside the mapping.
+  const uint8_t* pixels;
+};
+
+class wad_file_t {
+public:
+  explicit wad_file_t(const std::string& path);
+  ~wad_file_t();
+
+  wad_file_t(const wad_file_t&) = delete;
+  wad_file_t& operator=(const wad_file_t&) = delete;
+
+  // false if the file could not be mapped or is not a WAD2.
+  bool
+  is_valid() const;
+
+  const std::vector<miptex_t>&
+  get_textures() const;
+
+  // the 256 rgb entries of the wad's palette lump, null if it has none.
+  const uint8_t*
+  get_palette() const;
+
+private:
+  void
+  parse();
+
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+#if defined(_WIN32)
+  void* file = nullptr;
+  void* mapping = nullptr;
+#endif
+  std::vector<miptex_t> textures;
+  const uint8_t* palette = nullptr;
+};
+
+// true if the texture uses the palette entries quake draws at full brightness.
+// qpakman marked those textures with an '_fbr' suffix, the output keeps it.
+bool
+has_fullbright_pixels(const miptex_t& texture);
+
+// expands the texture through 'palette' (768 bytes) and writes it as an rgb
+// png. '{' textures are written as rgba, their index 255 fully transparent.
+bool
+write_png(
+  const miptex_t& texture,
+  const uint8_t* palette,
+  const std::string& path);
+
+}
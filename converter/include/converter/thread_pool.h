@@ -0,0 +1,92 @@
+/**
+ * @file thread_pool.h
+ * @author khalilhenoud@gmail.com
+ * @brief work-stealing thread pool, every worker owns a deque and steals from
+ * the others once its own runs dry.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class thread_pool_t {
+public:
+  using task_t = std::function<void()>;
+
+  // 0 picks the hardware concurrency.
+  explicit thread_pool_t(uint32_t thread_count = 0);
+  ~thread_pool_t();
+
+  thread_pool_t(const thread_pool_t&) = delete;
+  thread_pool_t& operator=(const thread_pool_t&) = delete;
+
+  // tasks submitted from a worker go to its own deque, external submissions
+  // are spread round robin.
+  void
+  submit(task_t task);
+
+  // blocks until every submitted task is done. The calling thread does not run
+  // tasks, at most size() of them are in flight.
+  void
+  wait();
+
+  // runs fn(0) .. fn(count - 1) across the workers and returns once all of
+  // them are done. The calling thread claims indices too and only waits on
+  // the ones already running elsewhere, so it is safe to call from a task.
+  // Every claimed batch is traced as 'name' on the thread that ran it, the
+  // name has to outlive the call (a literal).
+  void
+  parallel_for(
+    const char* name,
+    uint32_t count,
+    const std::function<void(uint32_t)>& fn);
+
+  uint32_t
+  size() const { return (uint32_t)threads.size(); }
+
+private:
+  struct queue_t {
+    std::mutex mutex;
+    std::deque<task_t> tasks;
+  };
+
+  // the owner pops from the front (submission order), thieves take the back.
+  bool
+  pop(uint32_t index, task_t& task);
+
+  bool
+  steal(uint32_t thief, task_t& task);
+
+  bool
+  find_task(uint32_t index, task_t& task);
+
+  void
+  run(task_t& task);
+
+  void
+  worker(uint32_t index);
+
+  std::vector<std::unique_ptr<queue_t>> queues;
+  std::vector<std::thread> threads;
+  std::atomic<uint32_t> next_queue{0};
+  // submitted but not yet finished / submitted but not yet picked up.
+  std::atomic<uint64_t> pending{0};
+  std::atomic<uint64_t> queued{0};
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable idle;
+  bool stop = false;
+};
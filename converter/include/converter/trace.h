@@ -0,0 +1,56 @@
+/**
+ * @file trace.h
+ * @author khalilhenoud@gmail.com
+ * @brief nested stage timings, written in the chrome trace event format (load
+ * the output in chrome://tracing or perfetto).
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+
+namespace trace {
+
+// spans are only recorded once tracing is enabled, otherwise a scope costs a
+// relaxed atomic load.
+void
+enable();
+
+bool
+is_enabled();
+
+// writes every span recorded so far, from every thread.
+bool
+write(const std::string& path);
+
+// drops the spans recorded so far, a long running process writes and clears
+// after each unit of work to keep the memory bounded.
+void
+clear();
+
+// records a complete ('X') event covering its lifetime on the calling thread,
+// nesting follows from the timestamps. The name also tags the allocations made
+// through the tracking allocator while the scope is alive, tracing or not.
+class scope_t {
+public:
+  explicit scope_t(const char* name, std::string detail = std::string());
+  ~scope_t();
+
+  scope_t(const scope_t&) = delete;
+  scope_t& operator=(const scope_t&) = delete;
+
+private:
+  const char* name;
+  const char* previous_tag;
+  std::string detail;
+  uint64_t start;
+  bool active;
+};
+
+}
@@ -0,0 +1,30 @@
+/**
+ * @file watch.h
+ * @author khalilhenoud@gmail.com
+ * @brief daemon mode, watches source directories and reconverts the scenes
+ * that change, reporting on a local unix socket.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+using convert_fn_t = std::function<bool(const char* scene_file)>;
+
+// blocks forever, returns non zero on setup failure. A scene is converted once
+// no write to it was seen for 'debounce_ms'. Every client connected to
+// 'socket_path' (optional) receives "converted <file> in <N> ms\n" lines.
+int
+run_watch(
+  const std::vector<std::string>& directories,
+  const std::string& socket_path,
+  uint32_t debounce_ms,
+  const convert_fn_t& convert);
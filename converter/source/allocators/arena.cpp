@@ -0,0 +1,236 @@
+/**
+ * @file arena.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <library/allocator/allocator.h>
+#include <converter/allocators/arena.h>
+
+
+namespace allocators {
+
+static constexpr size_t s_chunk_size = 4 * 1024 * 1024;
+static constexpr size_t s_alignment = 16;
+
+// precedes every block, realloc needs the size to copy a block that moves.
+struct alignas(s_alignment) header_t {
+  size_t size;
+};
+
+struct chunk_t {
+  uint8_t* data;
+  size_t capacity;
+  size_t offset;
+};
+
+struct arena_t {
+  ~arena_t()
+  {
+    for (auto& chunk : chunks)
+      free(chunk.data);
+  }
+
+  std::vector<chunk_t> chunks;
+  // index of the chunk serving regular allocations.
+  size_t current = 0;
+  // the only block that can grow in place (or be rolled back when freed).
+  uint8_t* last = nullptr;
+  size_t last_chunk = 0;
+  arena_stats_t stats;
+};
+
+static thread_local arena_t tl_arena;
+
+static
+uintptr_t
+align_up(uintptr_t value, size_t alignment)
+{
+  return (value + alignment - 1) & ~(uintptr_t)(alignment - 1);
+}
+
+// returns the aligned block position in 'chunk' or nullptr if it does not fit.
+static
+uint8_t*
+fit(const chunk_t& chunk, size_t size, size_t alignment)
+{
+  uintptr_t start = (uintptr_t)(chunk.data + chunk.offset) + sizeof(header_t);
+  uintptr_t block = align_up(start, alignment);
+  if (block + size > (uintptr_t)(chunk.data + chunk.capacity))
+    return nullptr;
+  return (uint8_t*)block;
+}
+
+static
+size_t
+add_chunk(arena_t& arena, size_t capacity)
+{
+  chunk_t chunk;
+  chunk.data = (uint8_t*)malloc(capacity);
+  assert(chunk.data && "allocation failed!");
+  chunk.capacity = capacity;
+  chunk.offset = 0;
+  arena.chunks.push_back(chunk);
+  arena.stats.reserved_bytes += capacity;
+  arena.stats.chunks++;
+  return arena.chunks.size() - 1;
+}
+
+static
+void*
+arena_allocate(size_t size, size_t alignment)
+{
+  arena_t& arena = tl_arena;
+  alignment = std::max(alignment, s_alignment);
+  size_t worst_case = size + alignment + sizeof(header_t);
+
+  size_t index;
+  uint8_t* block = nullptr;
+  if (arena.chunks.size())
+    block = fit(arena.chunks[arena.current], size, alignment);
+
+  if (block)
+    index = arena.current;
+  else if (worst_case > s_chunk_size / 2) {
+    // large blocks get a dedicated chunk, the current one keeps serving.
+    index = add_chunk(arena, worst_case);
+    block = fit(arena.chunks[index], size, alignment);
+  } else {
+    index = add_chunk(arena, s_chunk_size);
+    arena.current = index;
+    block = fit(arena.chunks[index], size, alignment);
+  }
+
+  chunk_t& chunk = arena.chunks[index];
+  size_t previous = chunk.offset;
+  ((header_t*)block - 1)->size = size;
+  chunk.offset = (size_t)(block + size - chunk.data);
+  arena.stats.used_bytes += chunk.offset - previous;
+  arena.stats.allocations++;
+  arena.last = block;
+  arena.last_chunk = index;
+  return block;
+}
+
+static
+void*
+allocate(size_t size)
+{
+  return arena_allocate(size, s_alignment);
+}
+
+static
+void*
+allocate_aligned(size_t size, size_t alignment)
+{
+  return arena_allocate(size, alignment);
+}
+
+static
+void*
+container_allocate(size_t count, size_t elem_size)
+{
+  // chunks are reused across resets, they are not zeroed.
+  void* block = arena_allocate(count * elem_size, s_alignment);
+  memset(block, 0, count * elem_size);
+  return block;
+}
+
+static
+void*
+reallocate(void* block, size_t size)
+{
+  if (!block)
+    return allocate(size);
+
+  arena_t& arena = tl_arena;
+  header_t* header = (header_t*)block - 1;
+
+  if ((uint8_t*)block == arena.last) {
+    chunk_t& chunk = arena.chunks[arena.last_chunk];
+    if ((uint8_t*)block + size <= chunk.data + chunk.capacity) {
+      size_t previous = chunk.offset;
+      chunk.offset = (size_t)((uint8_t*)block + size - chunk.data);
+      arena.stats.used_bytes += chunk.offset - previous;
+      header->size = size;
+      arena.stats.grown_in_place++;
+      return block;
+    }
+  }
+
+  size_t old_size = header->size;
+  void* moved = arena_allocate(size, s_alignment);
+  memcpy(moved, block, std::min(old_size, size));
+  arena.stats.allocations--;
+  arena.stats.moved++;
+  return moved;
+}
+
+static
+void
+free_block(void* block)
+{
+  // only the last block can be given back, the rest waits for the reset.
+  arena_t& arena = tl_arena;
+  if (!block || (uint8_t*)block != arena.last)
+    return;
+
+  chunk_t& chunk = arena.chunks[arena.last_chunk];
+  size_t offset = (size_t)((uint8_t*)block - sizeof(header_t) - chunk.data);
+  arena.stats.used_bytes -= chunk.offset - offset;
+  chunk.offset = offset;
+  arena.last = nullptr;
+}
+
+void
+setup_arena_allocator(allocator_t* allocator)
+{
+  allocator->mem_alloc = allocate;
+  allocator->mem_cont_alloc = container_allocate;
+  allocator->mem_free = free_block;
+  allocator->mem_alloc_alligned = allocate_aligned;
+  allocator->mem_realloc = reallocate;
+}
+
+void
+arena_reset()
+{
+  arena_t& arena = tl_arena;
+  if (arena.chunks.empty())
+    return;
+
+  auto largest = std::max_element(
+    arena.chunks.begin(), arena.chunks.end(),
+    [](const chunk_t& a, const chunk_t& b) { return a.capacity < b.capacity; });
+  chunk_t kept = *largest;
+  kept.offset = 0;
+  arena.chunks.erase(largest);
+  for (auto& chunk : arena.chunks)
+    free(chunk.data);
+
+  arena.chunks.clear();
+  arena.chunks.push_back(kept);
+  arena.current = 0;
+  arena.last = nullptr;
+  arena.last_chunk = 0;
+  arena.stats = arena_stats_t();
+  arena.stats.reserved_bytes = kept.capacity;
+  arena.stats.chunks = 1;
+}
+
+arena_stats_t
+arena_stats()
+{
+  return tl_arena.stats;
+}
+
+}
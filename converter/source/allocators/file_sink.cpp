@@ -0,0 +1,286 @@
+/**
+ * @file file_sink.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <library/allocator/allocator.h>
+#include <converter/allocators/file_sink.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+namespace allocators {
+
+// the mapping starts at 1 MiB and doubles, a remap does not copy the data, it
+// stays in the file.
+static constexpr size_t s_initial_capacity = 1024 * 1024;
+
+struct sink_t {
+#if defined(_WIN32)
+  HANDLE file = INVALID_HANDLE_VALUE;
+#else
+  int file = -1;
+#endif
+  uint8_t* view = nullptr;
+  size_t capacity = 0;
+  // the view handed to the stream, it is unmapped by the time it is freed.
+  uint8_t* released = nullptr;
+  // heap blocks and their sizes, needed to move the first block into the file.
+  std::unordered_map<void*, size_t> blocks;
+  // growing the mapping failed, the stream's buffer went back to the heap.
+  bool on_heap = false;
+};
+
+static thread_local sink_t tl_sink;
+
+static
+void
+unmap()
+{
+  sink_t& sink = tl_sink;
+  if (!sink.view)
+    return;
+
+#if defined(_WIN32)
+  UnmapViewOfFile(sink.view);
+#else
+  munmap(sink.view, sink.capacity);
+#endif
+  sink.view = nullptr;
+}
+
+static
+bool
+resize_file(size_t size)
+{
+  sink_t& sink = tl_sink;
+#if defined(_WIN32)
+  LARGE_INTEGER position;
+  position.QuadPart = (LONGLONG)size;
+  return
+    SetFilePointerEx(sink.file, position, NULL, FILE_BEGIN) &&
+    SetEndOfFile(sink.file);
+#else
+  return ftruncate(sink.file, (off_t)size) == 0;
+#endif
+}
+
+// unmaps, grows the file to 'capacity' and maps all of it again.
+static
+bool
+map(size_t capacity)
+{
+  sink_t& sink = tl_sink;
+  unmap();
+  if (!resize_file(capacity))
+    return false;
+
+#if defined(_WIN32)
+  HANDLE mapping = CreateFileMappingA(
+    sink.file, NULL, PAGE_READWRITE,
+    (DWORD)((uint64_t)capacity >> 32), (DWORD)(capacity & 0xffffffff), NULL);
+  if (!mapping)
+    return false;
+  sink.view = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, capacity);
+  // the view keeps the mapping alive.
+  CloseHandle(mapping);
+#else
+  void* view = mmap(
+    nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, sink.file, 0);
+  sink.view = view == MAP_FAILED ? nullptr : (uint8_t*)view;
+#endif
+
+  sink.capacity = sink.view ? capacity : 0;
+  return sink.view != nullptr;
+}
+
+// reads the first 'size' bytes of the file back into 'data'.
+static
+bool
+read_file(void* data, size_t size)
+{
+  sink_t& sink = tl_sink;
+  uint8_t* target = (uint8_t*)data;
+#if defined(_WIN32)
+  LARGE_INTEGER position;
+  position.QuadPart = 0;
+  if (!SetFilePointerEx(sink.file, position, NULL, FILE_BEGIN))
+    return false;
+  while (size) {
+    DWORD count = 0;
+    DWORD chunk = (DWORD)std::min(size, (size_t)0x40000000);
+    if (!ReadFile(sink.file, target, chunk, &count, NULL) || !count)
+      return false;
+    target += count;
+    size -= count;
+  }
+#else
+  off_t offset = 0;
+  while (size) {
+    ssize_t count = pread(sink.file, target, size, offset);
+    if (count <= 0)
+      return false;
+    target += count;
+    offset += count;
+    size -= (size_t)count;
+  }
+#endif
+  return true;
+}
+
+static
+void*
+allocate(size_t size)
+{
+  void* block = malloc(size);
+  if (block)
+    tl_sink.blocks[block] = size;
+  return block;
+}
+
+static
+void*
+container_allocate(size_t count, size_t elem_size)
+{
+  void* block = calloc(count, elem_size);
+  if (block)
+    tl_sink.blocks[block] = count * elem_size;
+  return block;
+}
+
+static
+void
+free_block(void* block)
+{
+  sink_t& sink = tl_sink;
+  if (!block || block == sink.view || block == sink.released)
+    return;
+
+  sink.blocks.erase(block);
+  free(block);
+}
+
+static
+void*
+reallocate(void* block, size_t size)
+{
+  sink_t& sink = tl_sink;
+  if (block && block == sink.view) {
+    size_t capacity = sink.capacity;
+    if (size <= capacity || map(std::max(size, capacity * 2)))
+      return sink.view;
+
+    // the old view is gone but its bytes are in the file, the buffer carries
+    // on as a heap block and file_sink_end writes it out.
+    sink.on_heap = true;
+    void* tmp = malloc(size);
+    if (tmp && !read_file(tmp, capacity)) {
+      free(tmp);
+      tmp = nullptr;
+    }
+    if (tmp)
+      sink.blocks[tmp] = size;
+    return tmp;
+  }
+
+  // the stream grows its buffer through realloc, the first block reallocated
+  // moves into the file. Blocks reallocated after that stay on the heap.
+  if (!sink.view && !sink.on_heap) {
+    size_t old_size = 0;
+    auto iter = sink.blocks.find(block);
+    if (iter != sink.blocks.end())
+      old_size = iter->second;
+
+    if (map(std::max(size, s_initial_capacity))) {
+      if (block) {
+        memcpy(sink.view, block, std::min(old_size, size));
+        free_block(block);
+      }
+      return sink.view;
+    }
+  }
+
+  void* tmp = realloc(block, size);
+  if (block)
+    sink.blocks.erase(block);
+  if (tmp)
+    sink.blocks[tmp] = size;
+  return tmp;
+}
+
+bool
+file_sink_begin(const std::string& path, allocator_t* allocator)
+{
+  sink_t& sink = tl_sink;
+  assert(!sink.view && sink.blocks.empty() && "a sink is already open!");
+  sink = sink_t();
+
+#if defined(_WIN32)
+  sink.file = CreateFileA(
+    path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+    FILE_ATTRIBUTE_NORMAL, NULL);
+  if (sink.file == INVALID_HANDLE_VALUE)
+    return false;
+#else
+  sink.file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (sink.file < 0)
+    return false;
+#endif
+
+  allocator->mem_alloc = allocate;
+  allocator->mem_cont_alloc = container_allocate;
+  allocator->mem_free = free_block;
+  allocator->mem_alloc_alligned = nullptr;
+  allocator->mem_realloc = reallocate;
+  return true;
+}
+
+bool
+file_sink_end(const void* data, size_t size)
+{
+  sink_t& sink = tl_sink;
+  bool success = true;
+  assert(
+    (!sink.view || data == sink.view) &&
+    "the mapped block is not the stream's buffer!");
+
+  // a stream that never grew holds its bytes in a heap block.
+  if (data != sink.view && size) {
+    success = map(size);
+    if (success)
+      memcpy(sink.view, data, size);
+  }
+
+  sink.released = sink.view;
+  unmap();
+  success = resize_file(size) && success;
+
+#if defined(_WIN32)
+  CloseHandle(sink.file);
+  sink.file = INVALID_HANDLE_VALUE;
+#else
+  close(sink.file);
+  sink.file = -1;
+#endif
+  return success;
+}
+
+}
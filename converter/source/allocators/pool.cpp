@@ -0,0 +1,360 @@
+/**
+ * @file pool.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <library/allocator/allocator.h>
+#include <converter/allocators/pool.h>
+
+
+namespace allocators {
+
+// block sizes, header included. Anything larger goes straight to malloc.
+static constexpr uint32_t s_class_sizes[] = {
+  32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640,
+  768, 896, 1024, 1280, 1536, 1792, 2048, 2560, 3072, 3584, 4096, 5120, 6144,
+  7168, 8192, 10240, 12288, 14336, 16384, 20480, 24576, 28672, 32768 };
+static constexpr uint32_t s_class_count =
+  sizeof(s_class_sizes) / sizeof(s_class_sizes[0]);
+static constexpr uint32_t s_largest_class = s_class_sizes[s_class_count - 1];
+static constexpr uint32_t s_slab_size = 64 * 1024;
+
+struct pool_account_t {
+  std::atomic<int64_t> current_bytes{0};
+  std::atomic<size_t> peak_bytes{0};
+  std::atomic<int64_t> live_blocks{0};
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<uint64_t> reallocations{0};
+  std::atomic<uint64_t> frees{0};
+};
+
+// precedes every block, keeps it 16 bytes aligned.
+struct alignas(16) header_t {
+  pool_account_t* account;
+  uint64_t size;
+};
+
+// a free block links to the next one through its first bytes.
+struct node_t {
+  node_t* next;
+};
+
+struct bin_t {
+  node_t* head = nullptr;
+  uint32_t count = 0;
+};
+
+struct shared_bin_t {
+  std::mutex mutex;
+  bin_t bin;
+};
+
+static shared_bin_t s_shared[s_class_count];
+
+static
+uint32_t
+batch_size(uint32_t size_class)
+{
+  return std::clamp<uint32_t>(
+    (32 * 1024) / s_class_sizes[size_class], 4, 64);
+}
+
+static
+void
+flush(bin_t& bin, uint32_t size_class, uint32_t count)
+{
+  // detach 'count' nodes locally, splice them under the lock.
+  node_t* first = bin.head;
+  node_t* last = first;
+  for (uint32_t i = 1; i < count; ++i)
+    last = last->next;
+  bin.head = last->next;
+  bin.count -= count;
+
+  shared_bin_t& shared = s_shared[size_class];
+  std::lock_guard<std::mutex> lock(shared.mutex);
+  last->next = shared.bin.head;
+  shared.bin.head = first;
+  shared.bin.count += count;
+}
+
+struct cache_t {
+  // blocks cached by an exiting thread go back to the shared pool.
+  ~cache_t()
+  {
+    for (uint32_t i = 0; i < s_class_count; ++i)
+      if (bins[i].count)
+        flush(bins[i], i, bins[i].count);
+  }
+
+  bin_t bins[s_class_count];
+};
+
+static thread_local cache_t tl_cache;
+static thread_local pool_account_t* tl_account = nullptr;
+
+static
+uint32_t
+get_size_class(size_t size)
+{
+  // exact lookup for the small sizes that dominate the scene building.
+  static const std::array<uint8_t, 64 + 1> s_small = []() {
+    std::array<uint8_t, 64 + 1> table{};
+    for (uint32_t i = 0; i <= 64; ++i)
+      table[i] = (uint8_t)(std::lower_bound(
+        s_class_sizes, s_class_sizes + s_class_count, i * 16) - s_class_sizes);
+    return table;
+  }();
+
+  if (size <= 1024)
+    return s_small[(size + 15) / 16];
+  return (uint32_t)(std::lower_bound(
+    s_class_sizes, s_class_sizes + s_class_count, size) - s_class_sizes);
+}
+
+static
+void
+refill(bin_t& bin, uint32_t size_class)
+{
+  uint32_t wanted = batch_size(size_class);
+  {
+    shared_bin_t& shared = s_shared[size_class];
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    while (shared.bin.head && bin.count < wanted) {
+      node_t* node = shared.bin.head;
+      shared.bin.head = node->next;
+      shared.bin.count--;
+      node->next = bin.head;
+      bin.head = node;
+      bin.count++;
+    }
+  }
+
+  if (bin.count)
+    return;
+
+  // NOTE: slabs are never returned to the system, the blocks they are carved
+  // into circulate between the caches and the shared pool for the lifetime of
+  // the process.
+  uint32_t block_size = s_class_sizes[size_class];
+  uint32_t slab_size = std::max(s_slab_size, block_size * 4);
+  uint8_t* slab = (uint8_t*)malloc(slab_size);
+  assert(slab && "allocation failed!");
+  for (uint32_t offset = 0; offset + block_size <= slab_size;
+    offset += block_size) {
+    node_t* node = (node_t*)(slab + offset);
+    node->next = bin.head;
+    bin.head = node;
+    bin.count++;
+  }
+}
+
+static
+void
+charge(pool_account_t* account, int64_t bytes)
+{
+  if (!account)
+    return;
+
+  size_t current = (size_t)(account->current_bytes.fetch_add(
+    bytes, std::memory_order_relaxed) + bytes);
+  size_t peak = account->peak_bytes.load(std::memory_order_relaxed);
+  while (
+    current > peak &&
+    !account->peak_bytes.compare_exchange_weak(
+      peak, current, std::memory_order_relaxed));
+}
+
+static
+void*
+allocate(size_t size)
+{
+  size_t total = size + sizeof(header_t);
+  header_t* header;
+  if (total > s_largest_class) {
+    header = (header_t*)malloc(total);
+    assert(header && "allocation failed!");
+  } else {
+    uint32_t size_class = get_size_class(total);
+    bin_t& bin = tl_cache.bins[size_class];
+    if (!bin.head)
+      refill(bin, size_class);
+    node_t* node = bin.head;
+    bin.head = node->next;
+    bin.count--;
+    header = (header_t*)node;
+  }
+
+  header->account = tl_account;
+  header->size = size;
+  if (header->account) {
+    header->account->allocations.fetch_add(1, std::memory_order_relaxed);
+    header->account->live_blocks.fetch_add(1, std::memory_order_relaxed);
+    charge(header->account, (int64_t)size);
+  }
+
+  return header + 1;
+}
+
+static
+void*
+container_allocate(size_t count, size_t elem_size)
+{
+  void* block = allocate(count * elem_size);
+  memset(block, 0, count * elem_size);
+  return block;
+}
+
+static
+void
+free_block(void* block)
+{
+  if (!block)
+    return;
+
+  header_t* header = (header_t*)block - 1;
+  if (header->account) {
+    header->account->frees.fetch_add(1, std::memory_order_relaxed);
+    header->account->live_blocks.fetch_sub(1, std::memory_order_relaxed);
+    charge(header->account, -(int64_t)header->size);
+  }
+
+  size_t total = header->size + sizeof(header_t);
+  if (total > s_largest_class) {
+    free(header);
+    return;
+  }
+
+  // the block lands in the cache of the thread freeing it, whichever thread
+  // allocated it.
+  uint32_t size_class = get_size_class(total);
+  bin_t& bin = tl_cache.bins[size_class];
+  node_t* node = (node_t*)header;
+  node->next = bin.head;
+  bin.head = node;
+  bin.count++;
+
+  uint32_t batch = batch_size(size_class);
+  if (bin.count > batch * 2)
+    flush(bin, size_class, batch);
+}
+
+static
+void*
+reallocate(void* block, size_t size)
+{
+  if (!block)
+    return allocate(size);
+
+  header_t* header = (header_t*)block - 1;
+  size_t old_total = header->size + sizeof(header_t);
+  size_t new_total = size + sizeof(header_t);
+  bool same_class =
+    old_total <= s_largest_class && new_total <= s_largest_class &&
+    get_size_class(old_total) == get_size_class(new_total);
+
+  if (old_total > s_largest_class && new_total > s_largest_class) {
+    if (header->account) {
+      header->account->reallocations.fetch_add(1, std::memory_order_relaxed);
+      charge(header->account, (int64_t)size - (int64_t)header->size);
+    }
+    header = (header_t*)realloc(header, new_total);
+    assert(header && "allocation failed!");
+    header->size = size;
+    return header + 1;
+  }
+
+  if (same_class) {
+    if (header->account) {
+      header->account->reallocations.fetch_add(1, std::memory_order_relaxed);
+      charge(header->account, (int64_t)size - (int64_t)header->size);
+    }
+    header->size = size;
+    return block;
+  }
+
+  // the new block keeps the account of the original one.
+  pool_account_t* account = tl_account;
+  tl_account = header->account;
+  void* tmp = allocate(size);
+  tl_account = account;
+
+  memcpy(tmp, block, std::min<size_t>(header->size, size));
+  if (header->account) {
+    // counted as a single reallocation, not an allocation and a free.
+    header->account->allocations.fetch_sub(1, std::memory_order_relaxed);
+    header->account->frees.fetch_sub(1, std::memory_order_relaxed);
+    header->account->reallocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  free_block(block);
+  return tmp;
+}
+
+void
+setup_pool_allocator(allocator_t* allocator)
+{
+  allocator->mem_alloc = allocate;
+  allocator->mem_cont_alloc = container_allocate;
+  allocator->mem_free = free_block;
+  allocator->mem_alloc_alligned = nullptr;
+  allocator->mem_realloc = reallocate;
+}
+
+void
+pool_begin()
+{
+  assert(!tl_account && "an account is already open on this thread!");
+  tl_account = new pool_account_t();
+}
+
+pool_report_t
+pool_end()
+{
+  pool_account_t* account = tl_account;
+  assert(account && "no account open on this thread!");
+  tl_account = nullptr;
+
+  pool_report_t report;
+  report.current_bytes = (size_t)account->current_bytes.load();
+  report.peak_bytes = account->peak_bytes.load();
+  report.allocations = account->allocations.load();
+  report.reallocations = account->reallocations.load();
+  report.frees = account->frees.load();
+  report.leaked_blocks = (uint64_t)account->live_blocks.load();
+
+  // leaked blocks still point to their account, it has to outlive them.
+  if (!report.leaked_blocks)
+    delete account;
+
+  return report;
+}
+
+void
+print_pool_report(const char* title, const pool_report_t& report)
+{
+  constexpr double to_mib = 1.0 / (1024.0 * 1024.0);
+  printf(
+    "\n'%s': job thread peak %.2f MiB, %llu allocations, %llu reallocations, "
+    "%llu leaked blocks (%zu bytes)\n",
+    title,
+    report.peak_bytes * to_mib,
+    (unsigned long long)report.allocations,
+    (unsigned long long)report.reallocations,
+    (unsigned long long)report.leaked_blocks,
+    report.current_bytes);
+}
+
+}
@@ -0,0 +1,241 @@
+/**
+ * @file tracking.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <library/allocator/allocator.h>
+#include <converter/allocators/tracking.h>
+
+
+namespace allocators {
+
+static constexpr const char* s_untagged = "untagged";
+
+struct block_t {
+  size_t size;
+  const char* tag;
+};
+
+struct tag_counters_t {
+  size_t current_bytes = 0;
+  size_t peak_bytes = 0;
+  size_t total_bytes = 0;
+  uint64_t allocations = 0;
+};
+
+struct tracking_state_t {
+  std::unordered_map<uintptr_t, block_t> blocks;
+  // keyed on the literal, merged by name when reporting.
+  std::unordered_map<const char*, tag_counters_t> tags;
+  const char* tag = s_untagged;
+  size_t current_bytes = 0;
+  size_t peak_bytes = 0;
+  uint64_t allocations = 0;
+  uint64_t reallocations = 0;
+  uint64_t frees = 0;
+};
+
+static thread_local tracking_state_t tl_state;
+
+static
+tag_counters_t&
+insert(void* block, size_t size, const char* tag)
+{
+  tracking_state_t& state = tl_state;
+  state.blocks[(uintptr_t)block] = { size, tag };
+  state.current_bytes += size;
+  state.peak_bytes = std::max(state.peak_bytes, state.current_bytes);
+
+  tag_counters_t& counters = state.tags[tag];
+  counters.current_bytes += size;
+  counters.peak_bytes = std::max(counters.peak_bytes, counters.current_bytes);
+  counters.total_bytes += size;
+  return counters;
+}
+
+static
+void
+track(void* block, size_t size)
+{
+  if (!block)
+    return;
+
+  tl_state.allocations++;
+  insert(block, size, tl_state.tag).allocations++;
+}
+
+static
+block_t
+untrack(void* block)
+{
+  tracking_state_t& state = tl_state;
+  auto iter = state.blocks.find((uintptr_t)block);
+  assert(iter != state.blocks.end() && "freeing an untracked block!");
+  if (iter == state.blocks.end())
+    return { 0, s_untagged };
+
+  block_t info = iter->second;
+  state.blocks.erase(iter);
+  state.current_bytes -= info.size;
+  state.tags[info.tag].current_bytes -= info.size;
+  return info;
+}
+
+static
+void*
+allocate(size_t size)
+{
+  void* block = malloc(size);
+  track(block, size);
+  return block;
+}
+
+static
+void*
+container_allocate(size_t count, size_t elem_size)
+{
+  void* block = calloc(count, elem_size);
+  track(block, count * elem_size);
+  return block;
+}
+
+static
+void*
+reallocate(void* block, size_t size)
+{
+  if (!block)
+    return allocate(size);
+
+  // the block keeps the tag it was allocated with.
+  block_t info = untrack(block);
+  void* tmp = realloc(block, size);
+  assert(tmp);
+
+  insert(tmp, size, info.tag);
+  tl_state.reallocations++;
+
+  return tmp;
+}
+
+static
+void
+free_block(void* block)
+{
+  if (!block)
+    return;
+
+  untrack(block);
+  tl_state.frees++;
+  free(block);
+}
+
+void
+setup_tracking_allocator(allocator_t* allocator)
+{
+  allocator->mem_alloc = allocate;
+  allocator->mem_cont_alloc = container_allocate;
+  allocator->mem_free = free_block;
+  allocator->mem_alloc_alligned = nullptr;
+  allocator->mem_realloc = reallocate;
+}
+
+void
+tracking_begin()
+{
+  const char* tag = tl_state.tag;
+  tl_state = tracking_state_t();
+  tl_state.tag = tag;
+}
+
+tracking_report_t
+tracking_end()
+{
+  tracking_state_t& state = tl_state;
+  tracking_report_t report;
+  report.current_bytes = state.current_bytes;
+  report.peak_bytes = state.peak_bytes;
+  report.allocations = state.allocations;
+  report.reallocations = state.reallocations;
+  report.frees = state.frees;
+
+  for (auto& entry : state.tags) {
+    auto iter = std::find_if(
+      report.tags.begin(), report.tags.end(),
+      [&](const tag_stats_t& stats) { return stats.tag == entry.first; });
+    if (iter == report.tags.end()) {
+      report.tags.push_back({});
+      iter = report.tags.end() - 1;
+      iter->tag = entry.first;
+    }
+
+    // NOTE: peaks of identically named tags from different literals can only
+    // be approximated by their sum.
+    iter->current_bytes += entry.second.current_bytes;
+    iter->peak_bytes += entry.second.peak_bytes;
+    iter->total_bytes += entry.second.total_bytes;
+    iter->allocations += entry.second.allocations;
+  }
+
+  std::sort(report.tags.begin(), report.tags.end(),
+    [](const tag_stats_t& a, const tag_stats_t& b) {
+      return a.peak_bytes > b.peak_bytes; });
+
+  for (auto& entry : state.blocks)
+    report.leaks.push_back({
+      entry.first, entry.second.size, entry.second.tag });
+
+  tracking_begin();
+  return report;
+}
+
+const char*
+set_tracking_tag(const char* tag)
+{
+  const char* previous = tl_state.tag;
+  tl_state.tag = tag ? tag : s_untagged;
+  return previous;
+}
+
+void
+print_tracking_report(
+  const char* title,
+  const tracking_report_t& report,
+  bool per_tag)
+{
+  constexpr double to_mib = 1.0 / (1024.0 * 1024.0);
+  printf(
+    "\n'%s': peak %.2f MiB, %llu allocations, %llu reallocations, "
+    "%zu leaks\n",
+    title,
+    report.peak_bytes * to_mib,
+    (unsigned long long)report.allocations,
+    (unsigned long long)report.reallocations,
+    report.leaks.size());
+
+  if (per_tag) {
+    for (auto& tag : report.tags)
+      printf(
+        "  %-24s peak %10.3f MiB, total %10.3f MiB, %8llu allocations\n",
+        tag.tag.c_str(),
+        tag.peak_bytes * to_mib,
+        tag.total_bytes * to_mib,
+        (unsigned long long)tag.allocations);
+  }
+
+  for (auto& leak : report.leaks)
+    printf(
+      "  leaked %zu bytes at 0x%llx (%s)\n",
+      leak.size, (unsigned long long)leak.address, leak.tag.c_str());
+}
+
+}
@@ -0,0 +1,105 @@
+/**
+ * @file batch.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <utility>
+#include <assimp/Importer.hpp>
+#include <converter/batch.h>
+#include <converter/utils.h>
+
+
+bool
+is_scene_file(const Assimp::Importer& importer, const std::string& path)
+{
+  if (path.find_last_of('.') == std::string::npos)
+    return false;
+
+  std::string extension = get_extension(path);
+  if (extension == "map")
+    return true;
+
+  return importer.IsExtensionSupported("." + extension);
+}
+
+std::vector<std::string>
+collect_batch_jobs(const std::string& source, uint32_t* rejected)
+{
+  std::vector<std::string> files;
+
+  if (std::filesystem::is_directory(source)) {
+    Assimp::Importer importer;
+    for (const auto& entry :
+      std::filesystem::recursive_directory_iterator(source)) {
+      if (!entry.is_regular_file())
+        continue;
+
+      std::string path = entry.path().string();
+      if (is_scene_file(importer, path))
+        files.push_back(path);
+    }
+    // the walk order is unspecified, keep the duplicate resolution stable.
+    std::sort(files.begin(), files.end());
+  } else {
+    std::ifstream list(source);
+    std::string line;
+    while (std::getline(list, line)) {
+      // tolerate windows line endings and blank lines.
+      line.erase(line.find_last_not_of(" \t\r\n") + 1);
+      if (line.empty() || line[0] == '#')
+        continue;
+      files.push_back(line);
+    }
+  }
+
+  // the output folder is named after the scene, two scenes sharing a name
+  // would convert into the same folder at the same time. The first one wins.
+  {
+    std::unordered_map<std::string, std::string> names;
+    std::vector<std::string> unique;
+    for (auto& file : files) {
+      std::string name = get_simple_name(file);
+      std::transform(name.begin(), name.end(), name.begin(),
+        [](unsigned char c) { return (char)std::tolower(c); });
+      auto inserted = names.emplace(name, file);
+      if (inserted.second)
+        unique.push_back(file);
+      else
+        printf(
+          "'%s' has the same output name as '%s', skipped.\n",
+          file.c_str(), inserted.first->second.c_str());
+    }
+    if (rejected)
+      *rejected = (uint32_t)(files.size() - unique.size());
+    files.swap(unique);
+  }
+
+  // biggest first, the work-stealing pool balances the tail.
+  std::vector<std::pair<uintmax_t, std::string>> sized;
+  for (auto& file : files) {
+    std::error_code error;
+    uintmax_t size = std::filesystem::file_size(file, error);
+    sized.emplace_back(error ? 0 : size, file);
+  }
+
+  std::stable_sort(sized.begin(), sized.end(),
+    [](const auto& a, const auto& b) { return a.first > b.first; });
+
+  files.clear();
+  for (auto& entry : sized)
+    files.push_back(entry.second);
+
+  return files;
+}
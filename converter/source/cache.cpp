@@ -0,0 +1,137 @@
+/**
+ * @file cache.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <converter/cache.h>
+
+
+namespace cache {
+
+static constexpr uint64_t s_fnv_offset = 14695981039346656037ull;
+static constexpr uint64_t s_fnv_prime = 1099511628211ull;
+static constexpr const char* s_header = "converter-cache 1";
+
+static
+std::string
+get_manifest_file(const std::string& target_path, const std::string& name)
+{
+  return target_path + "\\" + name + ".cache";
+}
+
+uint64_t
+hash_file(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return 0;
+
+  uint64_t hash = s_fnv_offset;
+  char buffer[1 << 16];
+  while (file) {
+    file.read(buffer, sizeof(buffer));
+    std::streamsize read = file.gcount();
+    for (std::streamsize i = 0; i < read; ++i) {
+      hash ^= (uint8_t)buffer[i];
+      hash *= s_fnv_prime;
+    }
+  }
+
+  return hash;
+}
+
+uint64_t
+combine(uint64_t seed, uint64_t value)
+{
+  for (uint32_t i = 0; i < 8; ++i) {
+    seed ^= (value >> (i * 8)) & 0xff;
+    seed *= s_fnv_prime;
+  }
+
+  return seed;
+}
+
+uint64_t
+make_key(
+  const std::string& scene_file,
+  uint64_t flags,
+  uint64_t build)
+{
+  uint64_t key = hash_file(scene_file);
+  key = combine(key, flags);
+  key = combine(key, build);
+  return key;
+}
+
+bool
+is_up_to_date(
+  const std::string& target_path,
+  const std::string& name,
+  uint64_t key)
+{
+  if (!std::filesystem::exists(target_path + "\\" + name + ".bin"))
+    return false;
+
+  std::ifstream manifest(get_manifest_file(target_path, name));
+  if (!manifest)
+    return false;
+
+  std::string line;
+  if (!std::getline(manifest, line) || line != s_header)
+    return false;
+
+  uint64_t stored_key = 0;
+  if (
+    !std::getline(manifest, line) ||
+    sscanf(line.c_str(), "%" SCNx64, &stored_key) != 1 ||
+    stored_key != key)
+    return false;
+
+  // every line after the key is '<hash> <path>'.
+  while (std::getline(manifest, line)) {
+    if (line.empty())
+      continue;
+
+    auto space = line.find(' ');
+    if (space == std::string::npos)
+      return false;
+
+    uint64_t stored_hash = 0;
+    sscanf(line.c_str(), "%" SCNx64, &stored_hash);
+    if (hash_file(line.substr(space + 1)) != stored_hash)
+      return false;
+  }
+
+  return true;
+}
+
+void
+store(
+  const std::string& target_path,
+  const std::string& name,
+  uint64_t key,
+  const std::vector<std::string>& dependencies)
+{
+  FILE* manifest = fopen(get_manifest_file(target_path, name).c_str(), "w");
+  if (!manifest)
+    return;
+
+  fprintf(manifest, "%s\n", s_header);
+  fprintf(manifest, "%016" PRIx64 "\n", key);
+  for (auto& dependency : dependencies)
+    fprintf(
+      manifest, "%016" PRIx64 " %s\n",
+      hash_file(dependency), dependency.c_str());
+  fclose(manifest);
+}
+
+}
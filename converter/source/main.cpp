@@ -9,83 +9,255 @@
  * 
  */
 #include <iostream>
+#include <atomic>
 #include <vector>
 #include <malloc.h>
 #include <algorithm>
 #include <functional>
 #include <filesystem>
 #include <cassert>
+#include <cstring>
 #include <library/allocator/allocator.h>
+#include <converter/allocators/arena.h>
+#include <converter/allocators/pool.h>
+#include <converter/allocators/tracking.h>
+#include <converter/batch.h>
+#include <converter/cache.h>
+#include <converter/context.h>
+#include <converter/thread_pool.h>
+#include <converter/trace.h>
 #include <converter/utils.h>
+#include <converter/watch.h>
 #include <converter/parsers/assimp/loader.h>
 #include <converter/parsers/quake/loader.h>
+#include <converter/parsers/quake/map.h>
+#include <assimp/Importer.hpp>
 
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
 
-std::string data_folder = "";
-std::string tools_folder = "";
 
-std::vector<uintptr_t> allocated;
+enum class allocator_kind_t {
+  tracking,
+  arena,
+  pool
+};
 
-void* allocate(size_t size)
+// the running binary, argv[0] can be relative, lack the extension or be found
+// through PATH. Empty when the system cannot tell.
+static
+std::string
+executable_path()
 {
-  void* block = malloc(size);
-  allocated.push_back(uintptr_t(block));
-  return block;
+#if defined(_WIN32)
+  std::vector<char> path(MAX_PATH);
+  for (;;) {
+    DWORD length = GetModuleFileNameA(NULL, path.data(), (DWORD)path.size());
+    if (!length)
+      return std::string();
+    if (length < path.size())
+      return std::string(path.data(), length);
+    path.resize(path.size() * 2);
+  }
+#else
+  std::error_code error;
+  std::filesystem::path path =
+    std::filesystem::read_symlink("/proc/self/exe", error);
+  return error ? std::string() : path.string();
+#endif
 }
 
-void* container_allocate(size_t count, size_t elem_size)
+static
+bool
+convert(
+  const char* scene_file,
+  const conversion_context_t* context,
+  const allocator_t* allocator,
+  allocator_kind_t kind,
+  bool memory_report)
 {
-  void* block = calloc(count, elem_size);
-  allocated.push_back(uintptr_t(block));
-  return block;
-}
+  // NOTE: a conversion runs start to finish on one thread, the tracking state,
+  // the arena and the pool account are per thread so the report covers this
+  // job alone.
+  if (kind == allocator_kind_t::tracking)
+    allocators::tracking_begin();
+  else if (kind == allocator_kind_t::pool)
+    allocators::pool_begin();
 
-void* reallocate(void* block, size_t size)
-{
-  void* tmp = realloc(block, size);
-  assert(tmp);
+  bool loaded;
+  {
+    trace::scope_t scope("convert", scene_file);
+    if (get_extension(scene_file) == "map")
+      loaded = load_qmap(scene_file, context, allocator);
+    else
+      loaded = load_assimp(scene_file, context, allocator);
+  }
 
-  uintptr_t item = (uintptr_t)block;
-  auto iter = std::find(allocated.begin(), allocated.end(), item);
-  assert(iter != allocated.end());
-  allocated.erase(iter);
+  if (kind == allocator_kind_t::arena) {
+    // nothing to leak, the whole scene goes away with the reset.
+    allocators::arena_stats_t stats = allocators::arena_stats();
+    printf(
+      "\n'%s': arena %.2f MiB used, %.2f MiB reserved in %u chunks, "
+      "%llu allocations, %llu grown in place, %llu moved\n",
+      scene_file,
+      stats.used_bytes / (1024.0 * 1024.0),
+      stats.reserved_bytes / (1024.0 * 1024.0),
+      stats.chunks,
+      (unsigned long long)stats.allocations,
+      (unsigned long long)stats.grown_in_place,
+      (unsigned long long)stats.moved);
+    allocators::arena_reset();
+    return loaded;
+  }
 
-  block = tmp;
-  allocated.push_back(uintptr_t(block));
+  if (kind == allocator_kind_t::pool) {
+    allocators::pool_report_t report = allocators::pool_end();
+    allocators::print_pool_report(scene_file, report);
+    return loaded && report.leaked_blocks == 0;
+  }
 
-  return block;
-}
+  allocators::tracking_report_t report = allocators::tracking_end();
+  allocators::print_tracking_report(scene_file, report, memory_report);
 
-void free_block(void* block)
-{
-  allocated.erase(
-    std::remove_if(
-      allocated.begin(), 
-      allocated.end(), 
-      [=](uintptr_t elem) { return (uintptr_t)block == elem; }), 
-    allocated.end());
-  free(block);
+  return loaded && report.leaks.empty();
 }
 
+// converter <data_folder> <tools_folder> <scene_file>
+// converter <data_folder> <tools_folder> --batch <list_file|directory>
+//   [--jobs N], N conversions at once on as many worker threads, the main
+//   thread only waits (hardware concurrency by default).
+// converter <data_folder> <tools_folder> --watch <directory> [--watch ...]
+//   [--socket <path>] [--debounce <ms>]
+// options: --no-cache, reconvert even if the cache manifest is up to date.
+//          --trace <file.json>, write the stage timings as a chrome trace,
+//          in watch mode it holds the latest conversion.
+//          --memory-report, print the per stage memory use of every scene.
+//          --alloc <tracking|arena|pool>, tracking (default) reports leaks
+//          per block, arena bump allocates and drops each scene at once, pool
+//          is thread safe and reports leaked block counts.
+//          --brush-engine <clip|mesh>, how quake brushes become polygons,
+//          clip (default) clips the polygons of a cube by every plane, mesh
+//          cuts the same cube kept as a mesh that shares its vertices.
 int main(int argc, char *argv[])
 {
-  allocator_t allocator;
-  allocator.mem_alloc = allocate;
-  allocator.mem_cont_alloc = container_allocate;
-  allocator.mem_free = free_block;
-  allocator.mem_alloc_alligned = nullptr;
-  allocator.mem_realloc = reallocate;
-
   assert(argc >= 4 && "provide path to mesh file!");
-  data_folder = argv[1];
-  tools_folder = argv[2];
-  const char* scene_file = argv[3];
+  conversion_context_t context;
+  context.data_folder = argv[1];
+  context.tools_folder = argv[2];
+
+  const char* batch_source = nullptr;
+  uint32_t jobs = 0;
+  std::vector<std::string> watch_directories;
+  std::string socket_path;
+  uint32_t debounce_ms = 150;
+  std::string trace_file;
+  bool memory_report = false;
+  allocator_kind_t kind = allocator_kind_t::tracking;
+  for (int i = 3; i < argc; ++i) {
+    if (!strcmp(argv[i], "--batch") && i + 1 < argc)
+      batch_source = argv[++i];
+    else if (!strcmp(argv[i], "--watch") && i + 1 < argc)
+      watch_directories.push_back(argv[++i]);
+    else if (!strcmp(argv[i], "--socket") && i + 1 < argc)
+      socket_path = argv[++i];
+    else if (!strcmp(argv[i], "--debounce") && i + 1 < argc)
+      debounce_ms = (uint32_t)std::stoul(argv[++i]);
+    else if (!strcmp(argv[i], "--jobs") && i + 1 < argc)
+      jobs = (uint32_t)std::stoul(argv[++i]);
+    else if (!strcmp(argv[i], "--no-cache"))
+      context.use_cache = false;
+    else if (!strcmp(argv[i], "--trace") && i + 1 < argc)
+      trace_file = argv[++i];
+    else if (!strcmp(argv[i], "--memory-report"))
+      memory_report = true;
+    else if (!strcmp(argv[i], "--alloc") && i + 1 < argc) {
+      ++i;
+      if (!strcmp(argv[i], "arena"))
+        kind = allocator_kind_t::arena;
+      else if (!strcmp(argv[i], "pool"))
+        kind = allocator_kind_t::pool;
+    } else if (!strcmp(argv[i], "--brush-engine") && i + 1 < argc)
+      context.mesh_cutting = !strcmp(argv[++i], "mesh");
+  }
 
-  if (get_extension(scene_file) == "map")
-    load_qmap(scene_file, &allocator);
+  allocator_t allocator;
+  if (kind == allocator_kind_t::arena) {
+    allocators::setup_arena_allocator(&allocator);
+    context.single_shot_release = true;
+  } else if (kind == allocator_kind_t::pool)
+    allocators::setup_pool_allocator(&allocator);
   else
-    load_assimp(scene_file, &allocator);
-  
-  assert(allocated.size() == 0);
-  return 0;
-}
\ No newline at end of file
+    allocators::setup_tracking_allocator(&allocator);
+
+  if (trace_file.size())
+    trace::enable();
+
+  {
+    // a different converter build invalidates every cached conversion.
+    std::string executable = executable_path();
+    context.build_hash = executable.size() ? cache::hash_file(executable) : 0;
+    if (context.use_cache && !context.build_hash) {
+      printf(
+        "warning: cannot hash the converter binary '%s', cache disabled.\n",
+        executable.c_str());
+      context.use_cache = false;
+    }
+  }
+
+  // batch jobs run on the pool, single and watch conversions use it for their
+  // parallel stages.
+  thread_pool_t pool(jobs);
+  context.pool = &pool;
+
+  if (watch_directories.size()) {
+    // one conversion at a time, the importer and the wad textures stay warm.
+    Assimp::Importer importer;
+    context.importer = &importer;
+    context.wad_cache = create_wad_texture_cache();
+    int result = run_watch(
+      watch_directories, socket_path, debounce_ms,
+      [&](const char* scene_file) {
+        bool success = convert(
+          scene_file, &context, &allocator, kind, memory_report);
+        // the daemon never exits, the trace holds the latest conversion so
+        // the events do not pile up.
+        if (trace_file.size()) {
+          trace::write(trace_file);
+          trace::clear();
+        }
+        return success;
+      });
+    free_wad_texture_cache(context.wad_cache);
+    return result;
+  }
+
+  if (!batch_source) {
+    const char* scene_file = argv[3];
+    bool success = convert(
+      scene_file, &context, &allocator, kind, memory_report);
+    if (trace_file.size())
+      trace::write(trace_file);
+    return success ? 0 : 1;
+  }
+
+  uint32_t rejected = 0;
+  std::vector<std::string> scene_files =
+    collect_batch_jobs(batch_source, &rejected);
+  printf("batch: %zu scenes\n", scene_files.size());
+
+  // the skipped duplicates count as failures.
+  std::atomic<uint32_t> failed{rejected};
+  for (auto& scene_file : scene_files)
+    pool.submit([&, scene_file]() {
+      if (!convert(
+        scene_file.c_str(), &context, &allocator, kind, memory_report))
+        failed.fetch_add(1);
+    });
+  pool.wait();
+
+  if (trace_file.size())
+    trace::write(trace_file);
+  return failed.load() == 0 ? 0 : 1;
+}
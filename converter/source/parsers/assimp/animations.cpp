@@ -11,6 +11,7 @@
 #include <cassert>
 #include <converter/parsers/assimp/animations.h>
 #include <converter/utils.h>
+#include <converter/trace.h>
 #include <assimp/scene.h>
 #include <assimp/types.h>
 #include <entity/scene/animation.h>
@@ -26,6 +27,8 @@ populate_animations(
   const aiScene *pScene,
   const allocator_t *allocator)
 {
+  trace::scope_t scope("populate_animations");
+
   cvector_setup(
     &scene->animation_repo, get_type_data(animation_t), 0, allocator);
   cvector_resize(&scene->animation_repo, pScene->mNumAnimations);
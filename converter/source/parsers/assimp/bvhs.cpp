@@ -20,6 +20,7 @@
 #include <entity/scene/scene.h>
 #include <converter/utils.h>
 #include <converter/parsers/quake/bvh_utils.h>
+#include <converter/trace.h>
 
 
 void
@@ -27,6 +28,8 @@ populate_bvhs(
   scene_t *scene,
   const allocator_t *allocator)
 {
+  trace::scope_t scope("populate_bvhs");
+
   // for now limit it to 1.
   cvector_setup(&scene->bvh_repo, get_type_data(bvh_t), 0, allocator);
 
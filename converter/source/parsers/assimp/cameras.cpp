@@ -20,6 +20,7 @@
 #include <entity/scene/scene.h>
 #include <converter/utils.h>
 #include <converter/parsers/assimp/lights.h>
+#include <converter/trace.h>
 
 
 void
@@ -28,6 +29,8 @@ populate_cameras(
   const aiScene *pScene,
   const allocator_t *allocator)
 {
+  trace::scope_t scope("populate_cameras");
+
   cvector_setup(&scene->camera_repo, get_type_data(camera_t), 4, allocator);
   cvector_resize(&scene->camera_repo, pScene->mNumCameras);
 
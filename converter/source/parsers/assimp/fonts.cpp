@@ -15,6 +15,7 @@
 #include <entity/misc/font.h>
 #include <entity/scene/scene.h>
 #include <converter/parsers/assimp/fonts.h>
+#include <converter/trace.h>
 
 
 void
@@ -22,6 +23,8 @@ populate_default_font(
   scene_t *scene,
   const allocator_t *allocator)
 {
+  trace::scope_t scope("populate_default_font");
+
   // set the font
   cvector_setup(&scene->font_repo, get_type_data(font_t), 4, allocator);
   cvector_resize(&scene->font_repo, 1);
@@ -18,6 +18,7 @@
 #include <entity/scene/scene.h>
 #include <converter/utils.h>
 #include <converter/parsers/assimp/lights.h>
+#include <converter/trace.h>
 
 
 void
@@ -26,6 +27,8 @@ populate_lights(
   const aiScene* pScene,
   const allocator_t* allocator)
 {
+  trace::scope_t scope("populate_lights");
+
   cvector_setup(&scene->light_repo, get_type_data(light_t), 1, allocator);
   cvector_resize(&scene->light_repo, pScene->mNumLights);
 
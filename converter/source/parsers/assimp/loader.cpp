@@ -10,6 +10,7 @@
  */
 #include <filesystem>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 #include <converter/parsers/assimp/animations.h>
@@ -23,6 +24,10 @@
 #include <converter/parsers/assimp/nodes.h>
 #include <converter/parsers/assimp/skinned_meshes.h>
 #include <converter/parsers/assimp/textures.h>
+#include <converter/allocators/file_sink.h>
+#include <converter/cache.h>
+#include <converter/context.h>
+#include <converter/trace.h>
 #include <converter/utils.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
@@ -30,30 +35,57 @@
 #include <entity/scene/scene.h>
 #include <library/allocator/allocator.h>
 #include <library/containers/cvector.h>
-#include <library/filesystem/io.h>
 #include <library/streams/binary_stream.h>
 
 
-extern std::string data_folder;
-extern std::string tools_folder;
 // TODO: This needs to change... The default args in the converter are not good
 // enough.
 static std::string defaulted_texture = "F:\\data\\textures\\default.png";
+static const uint32_t s_import_flags =
+  aiProcess_Triangulate |
+  aiProcess_GenSmoothNormals |
+  aiProcess_FlipUVs |
+  aiProcess_JoinIdenticalVertices;
 
-void
+bool
 load_assimp(
   const char* scene_file,
+  const conversion_context_t* context,
   const allocator_t* allocator)
 {
-  Assimp::Importer Importer;
+  // get the trimmed file name, since I want to use it to create a folder.
+  std::string name = get_simple_name(scene_file);
+  std::string target_path = context->data_folder + name;
+
+  // textures are only known after the import, they are recorded in the cache
+  // manifest as dependencies.
+  uint64_t cache_key;
+  {
+    trace::scope_t scope("cache_check");
+    cache_key = cache::make_key(
+      scene_file, s_import_flags, context->build_hash);
+    if (
+      context->use_cache &&
+      cache::is_up_to_date(target_path, name, cache_key)) {
+      printf("'%s' is up to date, skipping.\n", scene_file);
+      return true;
+    }
+  }
+
+  // constructing an importer registers every format, reuse the warm one.
+  std::unique_ptr<Assimp::Importer> LocalImporter;
+  if (!context->importer)
+    LocalImporter = std::make_unique<Assimp::Importer>();
+  Assimp::Importer& Importer =
+    context->importer ? *context->importer : *LocalImporter;
   Importer.SetPropertyBool(AI_CONFIG_IMPORT_COLLADA_IGNORE_UNIT_SIZE, true);
-  const aiScene* pScene = Importer.ReadFile(
-    scene_file,
-    aiProcess_Triangulate |
-    aiProcess_GenSmoothNormals |
-    aiProcess_FlipUVs |
-    aiProcess_JoinIdenticalVertices);
+  const aiScene* pScene = nullptr;
+  {
+    trace::scope_t scope("assimp_import");
+    pScene = Importer.ReadFile(scene_file, s_import_flags);
+  }
 
+  bool success = pScene != nullptr;
   if (!pScene)
     printf(
       "Error parsing '%s': '%s'\n", scene_file,
@@ -77,41 +109,66 @@ load_assimp(
     populate_default_font(scene, allocator);
     populate_bvhs(scene, allocator);
 
-    // get the trimmed file name, since I want to use it to create a folder.
-    std::string name = get_simple_name(scene_file);
-    std::string target_path = data_folder + name;
-    ensure_clean_directory(target_path);
-    std::string texture_target_path = target_path + "\\textures";
-    ensure_clean_directory(texture_target_path);
-    auto non_existing = filter_existing(textures);
-    replace_missing_files(
-      texture_target_path + "\\",
-      non_existing,
-      defaulted_texture);
-    copy_files(texture_target_path + "\\", textures);
+    std::vector<std::string> non_existing;
+    {
+      trace::scope_t scope("copy_textures");
+      ensure_clean_directory(target_path);
+      std::string texture_target_path = target_path + "\\textures";
+      ensure_clean_directory(texture_target_path);
+      non_existing = filter_existing(textures);
+      replace_missing_files(
+        texture_target_path + "\\",
+        non_existing,
+        defaulted_texture);
+      copy_files(texture_target_path + "\\", textures);
+    }
+
+    // a missing texture hashes to 0, it is picked up once it appears.
+    std::vector<std::string> dependencies = textures;
+    dependencies.insert(
+      dependencies.end(), non_existing.begin(), non_existing.end());
+    if (non_existing.size())
+      dependencies.push_back(defaulted_texture);
 
     // serialize the bin file.
     std::string target_bin = target_path + "\\" + name + ".bin";
-    binary_stream_t stream;
-    binary_stream_def(&stream);
-    binary_stream_setup(&stream, allocator);
-    scene_serialize(scene, &stream);
+    // the stream buffer is the mapped output file, serializing writes the .bin.
+    allocator_t sink;
+    success = allocators::file_sink_begin(target_bin, &sink);
+    if (!success)
+      printf("cannot open '%s' for writing!\n", target_bin.c_str());
+    else {
+      binary_stream_t stream;
+      binary_stream_def(&stream);
+      binary_stream_setup(&stream, &sink);
+      {
+        trace::scope_t scope("scene_serialize");
+        scene_serialize(scene, &stream);
+      }
 
-    {
-      file_handle_t file;
-      file = open_file(target_bin.c_str(),
-        file_open_flags_t(FILE_OPEN_MODE_WRITE | FILE_OPEN_MODE_BINARY));
-      assert((void *)file != NULL);
-      write_buffer(
-        file,
-        stream.data->data, stream.data->elem_data.size, stream.data->size);
-      close_file(file);
+      {
+        trace::scope_t scope("write_bin");
+        success = allocators::file_sink_end(
+          stream.data->data, stream.data->elem_data.size * stream.data->size);
+      }
+      binary_stream_cleanup(&stream);
+      if (!success)
+        printf("failed to write '%s'!\n", target_bin.c_str());
     }
 
-    binary_stream_cleanup(&stream);
-    scene_free(scene, allocator);
+    if (!context->single_shot_release) {
+      trace::scope_t scope("scene_free");
+      scene_free(scene, allocator);
+    }
+
+    if (success && context->use_cache)
+      cache::store(target_path, name, cache_key, dependencies);
   }
 
+  // a warm importer would otherwise hold on to the scene until the next read.
+  Importer.FreeScene();
+
   printf("\n");
   printf("done!");
+  return success;
 }
\ No newline at end of file
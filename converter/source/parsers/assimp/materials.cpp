@@ -22,6 +22,7 @@
 #include <entity/scene/scene.h>
 #include <converter/utils.h>
 #include <converter/parsers/assimp/materials.h>
+#include <converter/trace.h>
 
 
 std::vector<std::string>
@@ -30,6 +31,8 @@ populate_materials(
   const aiScene* pScene,
   const allocator_t* allocator)
 {
+  trace::scope_t scope("populate_materials");
+
   std::vector<std::string> textures;
 
   // NOTE: if pScene AI_SCENE_FLAGS_INCOMPLETE is set pScene might have no
@@ -11,6 +11,7 @@
 #include <cassert>
 #include <converter/parsers/assimp/meshes.h>
 #include <converter/utils.h>
+#include <converter/trace.h>
 #include <assimp/material.h>
 #include <assimp/scene.h>
 #include <assimp/types.h>
@@ -40,6 +41,8 @@ populate_meshes(
   const aiScene *pScene,
   const allocator_t *allocator)
 {
+  trace::scope_t scope("populate_meshes");
+
   cvector_setup(&scene->mesh_repo, get_type_data(mesh_t), 4, allocator);
   cvector_resize(&scene->mesh_repo, count_static_meshes(pScene));
 
@@ -14,6 +14,7 @@
 #include <vector>
 #include <converter/parsers/assimp/nodes.h>
 #include <converter/utils.h>
+#include <converter/trace.h>
 #include <assimp/material.h>
 #include <assimp/scene.h>
 #include <assimp/types.h>
@@ -32,6 +33,8 @@ populate_nodes(
   const aiScene* pScene,
   const allocator_t* allocator)
 {
+  trace::scope_t scope("populate_nodes");
+
   std::vector<uint32_t> meshes[2];      // static {0}, skinned {1}
   for (uint32_t i = 0; i < pScene->mNumMeshes; ++i)
     meshes[pScene->mMeshes[i]->HasBones() ? 1 : 0].push_back(i);
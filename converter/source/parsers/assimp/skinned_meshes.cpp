@@ -14,6 +14,7 @@
 #include <limits>
 #include <converter/parsers/assimp/skinned_meshes.h>
 #include <converter/utils.h>
+#include <converter/trace.h>
 #include <assimp/material.h>
 #include <assimp/scene.h>
 #include <assimp/types.h>
@@ -274,6 +275,8 @@ populate_skinned_meshes(
   const aiScene *pScene,
   const allocator_t *allocator)
 {
+  trace::scope_t scope("populate_skinned_meshes");
+
   cvector_setup(
     &scene->skinned_mesh_repo, get_type_data(skinned_mesh_t), 4, allocator);
   cvector_resize(&scene->skinned_mesh_repo, count_skinned_meshes(pScene));
@@ -18,6 +18,7 @@
 #include <entity/scene/scene.h>
 #include <converter/utils.h>
 #include <converter/parsers/assimp/textures.h>
+#include <converter/trace.h>
 
 
 void
@@ -26,6 +27,8 @@ populate_textures(
   const allocator_t* allocator,
   std::vector<std::string> textures)
 {
+  trace::scope_t scope("populate_textures");
+
   // adding the textures
   cvector_def(&scene->texture_repo);
 
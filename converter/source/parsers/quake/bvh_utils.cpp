@@ -11,6 +11,7 @@
 #include <assert.h>
 #include <library/allocator/allocator.h>
 #include <converter/parsers/quake/bvh_utils.h>
+#include <converter/trace.h>
 #include <entity/spatial/bvh.h>
 #include <entity/mesh/mesh.h>
 #include <entity/scene/node.h>
@@ -133,6 +134,7 @@ create_bvh_from_scene(
   scene_t* scene,
   const allocator_t* allocator)
 {
+  trace::scope_t scope("create_bvh_from_scene");
   bvh_t* bvh = NULL;
   float** vertices = NULL;
   uint32_t** indices = NULL;
@@ -0,0 +1,548 @@
+/**
+ * @file deflate.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <queue>
+#include <converter/parsers/quake/deflate.h>
+
+
+namespace deflate {
+
+static constexpr uint32_t s_window = 32768;
+static constexpr uint32_t s_min_match = 3;
+static constexpr uint32_t s_max_match = 258;
+// a match this long is taken without looking one byte ahead.
+static constexpr uint32_t s_nice_match = 128;
+static constexpr uint32_t s_max_chain = 128;
+static constexpr uint32_t s_hash_bits = 15;
+// the symbols of a block share one pair of huffman tables.
+static constexpr uint32_t s_block_tokens = 16384;
+
+static constexpr uint32_t s_litlen_codes = 286;
+static constexpr uint32_t s_dist_codes = 30;
+static constexpr uint32_t s_length_codes = 19;
+
+static const uint16_t s_length_base[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+  67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t s_length_extra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5,
+  5, 5, 5, 0 };
+static const uint16_t s_dist_base[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513,
+  769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t s_dist_extra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10,
+  11, 11, 12, 12, 13, 13 };
+// the order the code length code lengths are sent in.
+static const uint8_t s_length_order[s_length_codes] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// a literal when 'distance' is 0, else a match.
+struct token_t {
+  uint16_t value;
+  uint16_t distance;
+};
+
+static
+uint32_t
+length_code(uint32_t length)
+{
+  uint32_t code = 28;
+  while (s_length_base[code] > length)
+    --code;
+  return code;
+}
+
+static
+uint32_t
+dist_code(uint32_t distance)
+{
+  uint32_t code = 29;
+  while (s_dist_base[code] > distance)
+    --code;
+  return code;
+}
+
+class bit_writer_t {
+public:
+  explicit bit_writer_t(std::vector<uint8_t>& out) : out(out) {}
+
+  // deflate packs the bits from the least significant end.
+  void
+  put(uint32_t value, uint32_t count)
+  {
+    bits |= (uint64_t)value << filled;
+    filled += count;
+    while (filled >= 8) {
+      out.push_back((uint8_t)bits);
+      bits >>= 8;
+      filled -= 8;
+    }
+  }
+
+  void
+  align()
+  {
+    if (filled)
+      put(0, 8 - filled);
+  }
+
+private:
+  std::vector<uint8_t>& out;
+  uint64_t bits = 0;
+  uint32_t filled = 0;
+};
+
+// huffman code lengths no longer than 'limit' for the 'count' frequencies.
+// Deep trees are flattened by halving the frequencies until they fit.
+static
+void
+build_lengths(
+  const uint32_t* frequencies,
+  uint32_t count,
+  uint32_t limit,
+  uint8_t* lengths)
+{
+  struct node_t {
+    uint32_t weight;
+    int32_t left;
+    int32_t right;
+  };
+
+  std::vector<uint32_t> weights(frequencies, frequencies + count);
+  std::vector<node_t> nodes;
+  std::vector<uint8_t> depths;
+  for (;;) {
+    std::fill(lengths, lengths + count, 0);
+    nodes.clear();
+
+    using entry_t = std::pair<uint32_t, int32_t>;
+    std::priority_queue<
+      entry_t, std::vector<entry_t>, std::greater<entry_t>> queue;
+    for (uint32_t i = 0; i < count; ++i)
+      if (weights[i]) {
+        queue.emplace(weights[i], (int32_t)nodes.size());
+        nodes.push_back({ weights[i], -1, (int32_t)i });
+      }
+
+    if (nodes.empty())
+      return;
+
+    if (nodes.size() == 1) {
+      lengths[nodes[0].right] = 1;
+      return;
+    }
+
+    while (queue.size() > 1) {
+      entry_t a = queue.top();
+      queue.pop();
+      entry_t b = queue.top();
+      queue.pop();
+      queue.emplace(a.first + b.first, (int32_t)nodes.size());
+      nodes.push_back({ a.first + b.first, a.second, b.second });
+    }
+
+    // parents always come after their children, walk back from the root.
+    depths.assign(nodes.size(), 0);
+    uint32_t deepest = 0;
+    for (int32_t i = (int32_t)nodes.size() - 1; i >= 0; --i) {
+      const node_t& node = nodes[i];
+      if (node.left < 0) {
+        lengths[node.right] = depths[i];
+        deepest = std::max<uint32_t>(deepest, depths[i]);
+      } else {
+        depths[node.left] = depths[node.right] = depths[i] + 1;
+      }
+    }
+
+    if (deepest <= limit)
+      return;
+
+    for (auto& weight : weights)
+      if (weight)
+        weight = (weight + 1) / 2;
+  }
+}
+
+// canonical codes (rfc 1951 3.2.2), bit reversed so they can be sent least
+// significant bit first.
+static
+void
+build_codes(const uint8_t* lengths, uint32_t count, uint16_t* codes)
+{
+  uint32_t length_count[16] = { 0 };
+  for (uint32_t i = 0; i < count; ++i)
+    ++length_count[lengths[i]];
+  length_count[0] = 0;
+
+  uint32_t next[16] = { 0 };
+  for (uint32_t bits = 1, code = 0; bits < 16; ++bits) {
+    code = (code + length_count[bits - 1]) << 1;
+    next[bits] = code;
+  }
+
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t length = lengths[i];
+    if (!length) {
+      codes[i] = 0;
+      continue;
+    }
+
+    uint32_t code = next[length]++;
+    uint32_t reversed = 0;
+    for (uint32_t k = 0; k < length; ++k)
+      reversed |= ((code >> k) & 1) << (length - 1 - k);
+    codes[i] = (uint16_t)reversed;
+  }
+}
+
+// the literal/length and distance code lengths, run length coded with the
+// symbols 16 (repeat previous), 17 and 18 (runs of zeros). 'extra' holds the
+// repeat count of each symbol.
+static
+void
+encode_lengths(
+  const uint8_t* lengths,
+  uint32_t count,
+  std::vector<uint8_t>& symbols,
+  std::vector<uint8_t>& extra)
+{
+  for (uint32_t i = 0; i < count;) {
+    uint8_t length = lengths[i];
+    uint32_t run = 1;
+    while (i + run < count && lengths[i + run] == length)
+      ++run;
+    i += run;
+
+    if (!length) {
+      while (run >= 11) {
+        uint32_t part = std::min<uint32_t>(run, 138);
+        symbols.push_back(18);
+        extra.push_back((uint8_t)(part - 11));
+        run -= part;
+      }
+      if (run >= 3) {
+        symbols.push_back(17);
+        extra.push_back((uint8_t)(run - 3));
+        run = 0;
+      }
+    } else {
+      symbols.push_back(length);
+      extra.push_back(0);
+      --run;
+      while (run >= 3) {
+        uint32_t part = std::min<uint32_t>(run, 6);
+        symbols.push_back(16);
+        extra.push_back((uint8_t)(part - 3));
+        run -= part;
+      }
+    }
+
+    for (; run; --run) {
+      symbols.push_back(length);
+      extra.push_back(0);
+    }
+  }
+}
+
+static
+void
+write_stored(
+  bit_writer_t& writer,
+  std::vector<uint8_t>& out,
+  const uint8_t* data,
+  size_t size,
+  bool last)
+{
+  size_t offset = 0;
+  do {
+    size_t length = std::min<size_t>(size - offset, 65535);
+    bool final = last && offset + length == size;
+    writer.put(final ? 1 : 0, 3);
+    writer.align();
+    writer.put((uint32_t)length, 16);
+    writer.put((uint32_t)~length & 0xffff, 16);
+    out.insert(out.end(), data + offset, data + offset + length);
+    offset += length;
+  } while (offset < size);
+}
+
+// one dynamic huffman block for 'tokens', or stored blocks for the 'size' raw
+// bytes at 'data' they stand for when that is smaller.
+static
+void
+write_block(
+  bit_writer_t& writer,
+  std::vector<uint8_t>& out,
+  const std::vector<token_t>& tokens,
+  const uint8_t* data,
+  size_t size,
+  bool last)
+{
+  uint32_t litlen_frequencies[s_litlen_codes] = { 0 };
+  uint32_t dist_frequencies[s_dist_codes] = { 0 };
+  for (const token_t& token : tokens) {
+    if (!token.distance)
+      ++litlen_frequencies[token.value];
+    else {
+      ++litlen_frequencies[257 + length_code(token.value)];
+      ++dist_frequencies[dist_code(token.distance)];
+    }
+  }
+  litlen_frequencies[256] = 1;
+
+  // NOTE: some inflaters reject a table with a single code, give every table
+  // at least two.
+  uint32_t used = s_dist_codes -
+    (uint32_t)std::count(dist_frequencies, dist_frequencies + s_dist_codes, 0u);
+  for (uint32_t i = 0; i < s_dist_codes && used < 2; ++i)
+    if (!dist_frequencies[i]) {
+      dist_frequencies[i] = 1;
+      ++used;
+    }
+  if (tokens.empty())
+    litlen_frequencies[0] = 1;
+
+  uint8_t litlen_lengths[s_litlen_codes];
+  uint8_t dist_lengths[s_dist_codes];
+  build_lengths(litlen_frequencies, s_litlen_codes, 15, litlen_lengths);
+  build_lengths(dist_frequencies, s_dist_codes, 15, dist_lengths);
+
+  uint32_t litlen_count = s_litlen_codes;
+  while (litlen_count > 257 && !litlen_lengths[litlen_count - 1])
+    --litlen_count;
+  uint32_t dist_count = s_dist_codes;
+  while (dist_count > 1 && !dist_lengths[dist_count - 1])
+    --dist_count;
+
+  // both tables are sent as one sequence of code lengths.
+  uint8_t all_lengths[s_litlen_codes + s_dist_codes];
+  std::copy(litlen_lengths, litlen_lengths + litlen_count, all_lengths);
+  std::copy(
+    dist_lengths, dist_lengths + dist_count, all_lengths + litlen_count);
+  std::vector<uint8_t> symbols, extra;
+  encode_lengths(all_lengths, litlen_count + dist_count, symbols, extra);
+
+  uint32_t length_frequencies[s_length_codes] = { 0 };
+  for (uint8_t symbol : symbols)
+    ++length_frequencies[symbol];
+  uint8_t length_lengths[s_length_codes];
+  build_lengths(length_frequencies, s_length_codes, 7, length_lengths);
+
+  uint32_t length_count = s_length_codes;
+  while (length_count > 4 && !length_lengths[s_length_order[length_count - 1]])
+    --length_count;
+
+  static const uint8_t s_symbol_extra[3] = { 2, 3, 7 };
+  uint64_t bits = 3 + 5 + 5 + 4 + 3 * length_count;
+  for (uint8_t symbol : symbols)
+    bits +=
+      length_lengths[symbol] + (symbol >= 16 ? s_symbol_extra[symbol - 16] : 0);
+  for (const token_t& token : tokens) {
+    if (!token.distance)
+      bits += litlen_lengths[token.value];
+    else {
+      uint32_t length = length_code(token.value);
+      uint32_t distance = dist_code(token.distance);
+      bits +=
+        litlen_lengths[257 + length] + s_length_extra[length] +
+        dist_lengths[distance] + s_dist_extra[distance];
+    }
+  }
+  bits += litlen_lengths[256];
+
+  uint64_t stored_bits = ((size + 65534) / 65535) * (3 + 7 + 32) + size * 8;
+  if (stored_bits < bits) {
+    write_stored(writer, out, data, size, last);
+    return;
+  }
+
+  uint16_t litlen_codes[s_litlen_codes];
+  uint16_t dist_codes[s_dist_codes];
+  uint16_t length_codes[s_length_codes];
+  build_codes(litlen_lengths, s_litlen_codes, litlen_codes);
+  build_codes(dist_lengths, s_dist_codes, dist_codes);
+  build_codes(length_lengths, s_length_codes, length_codes);
+
+  writer.put(last ? 1 : 0, 1);
+  writer.put(2, 2);
+  writer.put(litlen_count - 257, 5);
+  writer.put(dist_count - 1, 5);
+  writer.put(length_count - 4, 4);
+  for (uint32_t i = 0; i < length_count; ++i)
+    writer.put(length_lengths[s_length_order[i]], 3);
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    uint8_t symbol = symbols[i];
+    writer.put(length_codes[symbol], length_lengths[symbol]);
+    if (symbol >= 16)
+      writer.put(extra[i], s_symbol_extra[symbol - 16]);
+  }
+
+  for (const token_t& token : tokens) {
+    if (!token.distance) {
+      writer.put(litlen_codes[token.value], litlen_lengths[token.value]);
+      continue;
+    }
+
+    uint32_t length = length_code(token.value);
+    writer.put(litlen_codes[257 + length], litlen_lengths[257 + length]);
+    writer.put(token.value - s_length_base[length], s_length_extra[length]);
+    uint32_t distance = dist_code(token.distance);
+    writer.put(dist_codes[distance], dist_lengths[distance]);
+    writer.put(token.distance - s_dist_base[distance], s_dist_extra[distance]);
+  }
+  writer.put(litlen_codes[256], litlen_lengths[256]);
+}
+
+// hash chains over the last 32KiB, 'head' holds the latest position of every
+// 3 byte hash and 'previous' the one before it.
+class matcher_t {
+public:
+  matcher_t(const uint8_t* data, size_t size)
+    : data(data)
+    , size(size)
+    , head((size_t)1 << s_hash_bits, -1)
+    , previous(s_window, -1)
+  {}
+
+  void
+  insert(size_t position)
+  {
+    if (position + s_min_match > size)
+      return;
+    uint32_t hash = get_hash(position);
+    previous[position & (s_window - 1)] = head[hash];
+    head[hash] = (int64_t)position;
+  }
+
+  // the longest earlier match at 'position', 0 when there is none.
+  uint32_t
+  find(size_t position, uint32_t& distance) const
+  {
+    uint32_t limit = (uint32_t)std::min<size_t>(s_max_match, size - position);
+    if (limit < s_min_match)
+      return 0;
+
+    uint32_t best = s_min_match - 1;
+    const uint8_t* current = data + position;
+    int64_t candidate = head[get_hash(position)];
+    for (uint32_t chain = s_max_chain; candidate >= 0 && chain; --chain) {
+      // a slot reused by a newer position ends the chain.
+      if (
+        (size_t)candidate >= position ||
+        position - (size_t)candidate > s_window)
+        break;
+
+      const uint8_t* earlier = data + candidate;
+      if (earlier[best] == current[best] && earlier[0] == current[0]) {
+        uint32_t length = 0;
+        while (length < limit && earlier[length] == current[length])
+          ++length;
+        if (length > best) {
+          best = length;
+          distance = (uint32_t)(position - (size_t)candidate);
+          if (length == limit)
+            break;
+        }
+      }
+
+      int64_t next = previous[(size_t)candidate & (s_window - 1)];
+      if (next >= candidate)
+        break;
+      candidate = next;
+    }
+
+    return best >= s_min_match ? best : 0;
+  }
+
+private:
+  uint32_t
+  get_hash(size_t position) const
+  {
+    const uint8_t* p = data + position;
+    uint32_t value = p[0] | (p[1] << 8) | (p[2] << 16);
+    return (value * 2654435761u) >> (32 - s_hash_bits);
+  }
+
+  const uint8_t* data;
+  size_t size;
+  std::vector<int64_t> head;
+  std::vector<int64_t> previous;
+};
+
+std::vector<uint8_t>
+zlib_compress(const uint8_t* data, size_t size)
+{
+  // 32KiB window, default compression level.
+  std::vector<uint8_t> out = { 0x78, 0x9c };
+  out.reserve(size / 2 + 64);
+  bit_writer_t writer(out);
+  matcher_t matcher(data, size);
+
+  std::vector<token_t> tokens;
+  tokens.reserve(s_block_tokens + 1);
+  size_t position = 0, block_start = 0;
+  while (position < size) {
+    uint32_t distance = 0;
+    uint32_t length = matcher.find(position, distance);
+    matcher.insert(position);
+
+    // lazy matching, a longer match one byte later wins over this one.
+    if (length && length < s_nice_match && position + 1 < size) {
+      uint32_t next_distance = 0;
+      uint32_t next_length = matcher.find(position + 1, next_distance);
+      if (next_length > length)
+        length = 0;
+    }
+
+    if (!length) {
+      tokens.push_back({ data[position], 0 });
+      ++position;
+    } else {
+      tokens.push_back({ (uint16_t)length, (uint16_t)distance });
+      for (size_t i = position + 1; i < position + length; ++i)
+        matcher.insert(i);
+      position += length;
+    }
+
+    if (tokens.size() >= s_block_tokens || position == size) {
+      write_block(
+        writer, out, tokens, data + block_start, position - block_start,
+        position == size);
+      tokens.clear();
+      block_start = position;
+    }
+  }
+
+  if (!size)
+    write_block(writer, out, tokens, data, 0, true);
+  writer.align();
+
+  uint32_t a = 1, b = 0;
+  for (size_t offset = 0; offset < size;) {
+    // the sums cannot overflow within 5552 bytes.
+    size_t end = std::min<size_t>(size, offset + 5552);
+    for (; offset < end; ++offset) {
+      a += data[offset];
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+  }
+  uint32_t adler = (b << 16) | a;
+  out.push_back((uint8_t)(adler >> 24));
+  out.push_back((uint8_t)(adler >> 16));
+  out.push_back((uint8_t)(adler >> 8));
+  out.push_back((uint8_t)adler);
+  return out;
+}
+
+}
@@ -15,7 +15,10 @@
 #include <library/allocator/allocator.h>
 #include <library/containers/cvector.h>
 #include <library/streams/binary_stream.h>
-#include <library/filesystem/io.h>
+#include <converter/allocators/file_sink.h>
+#include <converter/cache.h>
+#include <converter/context.h>
+#include <converter/trace.h>
 #include <converter/parsers/quake/loader.h>
 #include <converter/parsers/quake/map.h>
 #include <converter/utils.h>
@@ -23,50 +26,99 @@
 #include <entity/scene/scene.h>
 
 
-extern std::string data_folder;
-extern std::string tools_folder;
-
-void
+bool
 load_qmap(
   const char* scene_file,
+  const conversion_context_t* context,
   const allocator_t* allocator)
 {
-  loader_map_data_t* map = load_map(scene_file, allocator);
-  printf("loading map file successful!");
+  // get the trimmed file name, since I want to use it to create a folder.
+  std::string name = get_simple_name(scene_file);
+  std::string target_path = context->data_folder + name;
 
-  scene_t *scene = scene_create(NULL, allocator);
-  std::vector<std::string> textures = map_to_bin(
-    scene_file, map, scene, allocator);
+  // the brush engine stands in for the import flags, the wad and the fallback
+  // palette are tracked as dependencies.
+  uint64_t cache_key;
+  {
+    trace::scope_t scope("cache_check");
+    cache_key = cache::make_key(
+      scene_file, context->mesh_cutting ? 1 : 0, context->build_hash);
+    if (
+      context->use_cache &&
+      cache::is_up_to_date(target_path, name, cache_key)) {
+      printf("'%s' is up to date, skipping.\n", scene_file);
+      return true;
+    }
+  }
 
-  free_map(map, allocator);
+  loader_map_data_t* map = nullptr;
+  {
+    trace::scope_t scope("load_map");
+    map = load_map(scene_file, allocator);
+  }
+  printf("loading map file successful!");
+  std::string wad_file = get_wad_file(scene_file, map->world.wad);
 
-  // get the trimmed file name, since I want to use it to create a folder.
-  std::string name = get_simple_name(scene_file);
-  std::string target_path = data_folder + name;
-  ensure_clean_directory(target_path);
+  // the textures are written straight from the wad into the output.
   std::string texture_target_path = target_path + "\\textures";
+  ensure_clean_directory(target_path);
   ensure_clean_directory(texture_target_path);
-  copy_files(texture_target_path + "\\", textures);
+
+  scene_t *scene = scene_create(NULL, allocator);
+  bool converted = map_to_bin(
+    scene_file, map, scene, texture_target_path + "\\", context, allocator);
+
+  if (!context->single_shot_release)
+    free_map(map, allocator);
+
+  // no .bin and no cache manifest, the next run tries again.
+  if (!converted) {
+    if (!context->single_shot_release)
+      scene_free(scene, allocator);
+    return false;
+  }
 
   std::string target_bin = target_path + "\\" + name + ".bin";
+  // the stream buffer is the mapped output file, serializing writes the .bin.
+  allocator_t sink;
+  if (!allocators::file_sink_begin(target_bin, &sink)) {
+    printf("cannot open '%s' for writing!\n", target_bin.c_str());
+    if (!context->single_shot_release)
+      scene_free(scene, allocator);
+    return false;
+  }
+
   binary_stream_t stream;
   binary_stream_def(&stream);
-  binary_stream_setup(&stream, allocator);
-  scene_serialize(scene, &stream);
-
+  binary_stream_setup(&stream, &sink);
   {
-    file_handle_t file;
-    file = open_file(target_bin.c_str(),
-      file_open_flags_t(FILE_OPEN_MODE_WRITE | FILE_OPEN_MODE_BINARY));
-    assert((void *)file != NULL);
-    write_buffer(
-      file,
-      stream.data->data, stream.data->elem_data.size, stream.data->size);
-    close_file(file);
+    trace::scope_t scope("scene_serialize");
+    scene_serialize(scene, &stream);
   }
 
+  bool written;
+  {
+    trace::scope_t scope("write_bin");
+    written = allocators::file_sink_end(
+      stream.data->data, stream.data->elem_data.size * stream.data->size);
+  }
   binary_stream_cleanup(&stream);
-  scene_free(scene, allocator);
+
+  if (!context->single_shot_release) {
+    trace::scope_t scope("scene_free");
+    scene_free(scene, allocator);
+  }
+
+  if (!written) {
+    printf("failed to write '%s'!\n", target_bin.c_str());
+    return false;
+  }
+
+  if (context->use_cache)
+    cache::store(
+      target_path, name, cache_key,
+      { wad_file, context->tools_folder + "palette.lmp" });
 
   printf("done!");
+  return true;
 }
\ No newline at end of file
@@ -9,11 +9,14 @@
  *
  */
 #include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <library/allocator/allocator.h>
 #include <library/containers/cvector.h>
 #include <library/string/cstring.h>
@@ -33,7 +36,9 @@
 #include <entity/scene/node.h>
 #include <entity/scene/scene.h>
 #include <loaders/loader_map.h>
-#include <loaders/loader_png.h>
+#include <converter/context.h>
+#include <converter/thread_pool.h>
+#include <converter/trace.h>
 #include <converter/utils.h>
 #include <converter/parsers/quake/topology/brush.h>
 #include <converter/parsers/quake/topology/poly_brush.h>
@@ -41,90 +46,166 @@
 #include <converter/parsers/quake/map.h>
 #include <converter/parsers/quake/bvh_utils.h>
 #include <converter/parsers/quake/string_utils.h>
+#include <converter/parsers/quake/wad.h>
 
 
 struct texture_entry_t {
   std::string path;
-  loader_png_data_t* png_data = nullptr;
+  // the miptex inside the mapped wad, its pixels are only read when the png is
+  // written.
+  const wad::miptex_t* miptex = nullptr;
   uint32_t index = 0;
   std::vector<uint32_t> indices;
 };
 
 using texture_map_t = std::unordered_map<std::string, texture_entry_t>;
 
+using texture_set_t = std::unordered_set<std::string>;
+
+// the sanitized names of the textures the world brushes actually use, most of
+// an id1 wad is never referenced by a given map.
+static
+texture_set_t
+collect_referenced_textures(const loader_map_data_t* map_data)
+{
+  texture_set_t referenced;
+  for (uint32_t i = 0; i < map_data->world.brush_count; ++i) {
+    const loader_map_brush_data_t* brush = map_data->world.brushes + i;
+    for (uint32_t j = 0; j < brush->face_count; ++j) {
+      std::string name = string_utils::get_sanitized(brush->faces[j].texture);
+      if (name.size())
+        referenced.insert(name);
+    }
+  }
+  return referenced;
+}
+
 static
 void
-free_texture_data(
-  texture_map_t& tex_map,
-  const allocator_t* allocator)
+load_texture_data(
+  const wad::wad_file_t& wad,
+  const texture_set_t& referenced,
+  texture_map_t& tex_map)
 {
-  for (auto& data : tex_map)
-    free_png(data.second.png_data, allocator);
+  trace::scope_t scope("load_texture_data");
 
-  tex_map.clear();
+  // only the lump headers are read, the width and height are all the uvs need.
+  // the indices stay dense, they double as texture, material and mesh indices.
+  uint32_t index = 0;
+  for (auto& miptex : wad.get_textures()) {
+    // the map references the textures by their sanitized names.
+    std::string name = string_utils::get_sanitized(miptex.name);
+    if (referenced.find(name) == referenced.end())
+      continue;
+
+    texture_entry_t entry;
+    entry.path = name;
+    if (wad::has_fullbright_pixels(miptex))
+      entry.path += "_fbr";
+    entry.path += ".png";
+    entry.miptex = &miptex;
+    entry.index = index;
+    if (tex_map.emplace(name, entry).second)
+      ++index;
+  }
+
+  for (auto& name : referenced)
+    if (tex_map.find(name) == tex_map.end())
+      printf("texture '%s' is not in the wad, its faces are dropped.\n",
+        name.c_str());
+
+  printf("textures: %u referenced, %u in the wad.\n",
+    (uint32_t)tex_map.size(), (uint32_t)wad.get_textures().size());
 }
 
+// the wad's palette lump, else 'palette.lmp' in the tools folder, else a gray
+// ramp so the conversion still goes through.
 static
-texture_vec_t
-load_texture_data(
-  const char* scene_file,
-  std::string wad_directory,
-  texture_map_t& tex_map,
-  const allocator_t* allocator)
+std::vector<uint8_t>
+load_palette(
+  const wad::wad_file_t& wad,
+  const conversion_context_t* context)
 {
-  extern std::string tools_folder;
-  texture_vec_t textures;
+  std::vector<uint8_t> palette(768);
+  if (const uint8_t* lump = wad.get_palette()) {
+    memcpy(palette.data(), lump, palette.size());
+    return palette;
+  }
 
-  // this will produce the wad extraction directory.
-  std::string directory = scene_file;
-  auto iter = directory.find_last_of("\\/");
-  directory = directory.substr(0, iter + 1);
-  std::replace(wad_directory.begin(), wad_directory.end(), '/', '\\');
-  directory += wad_directory;
+  std::string path = context->tools_folder + "palette.lmp";
+  if (FILE* file = fopen(path.c_str(), "rb")) {
+    size_t read = fread(palette.data(), 1, palette.size(), file);
+    fclose(file);
+    if (read == palette.size())
+      return palette;
+  }
+
+  printf("no palette found (wad or '%s'), using a gray ramp.\n", path.c_str());
+  for (uint32_t i = 0; i < 256; ++i)
+    palette[i * 3 + 0] = palette[i * 3 + 1] = palette[i * 3 + 2] = (uint8_t)i;
+  return palette;
+}
+
+// false if any texture could not be written, the others are still written.
+static
+bool
+write_textures(
+  const texture_map_t& tex_map,
+  const std::vector<uint8_t>& palette,
+  const std::string& texture_directory)
+{
+  trace::scope_t scope("write_textures");
+  bool written = true;
+  for (auto& entry : tex_map) {
+    std::string path = texture_directory + entry.second.path;
+    if (!wad::write_png(*entry.second.miptex, palette.data(), path)) {
+      printf("failed to write '%s'!\n", path.c_str());
+      written = false;
+    }
+  }
+  return written;
+}
 
+// a mesh corner, position, normal and uv. Corners only share a vertex when all
+// of them match bit for bit (+0 and -0 aside), so a uv seam keeps both sides.
+struct mesh_vertex_t {
+  float data[9];
+
+  mesh_vertex_t(
+    const point3f& position,
+    const vector3f& normal,
+    const point3f& uv)
   {
-    // get the canonical wad file path.
-    std::string wadfile = directory;
-    wadfile += ".wad";
-    auto wad_canonical = std::filesystem::canonical(wadfile).string();
-
-    // ensure the extraction directory is created and clean. Set it as the
-    // current path so we can extract into it.
-    ensure_clean_directory(directory);
-    auto previous_path = std::filesystem::current_path();
-    std::filesystem::current_path(directory);
-
-    // extract the wad into the directory.
-    std::string buffer = tools_folder;
-    buffer += "qpakman -extract ";
-    buffer += wad_canonical;
-    system(buffer.c_str());
-
-    // restore our working directory.
-    std::filesystem::current_path(previous_path);
+    for (uint32_t i = 0; i < 3; ++i) {
+      // adding 0 turns -0 into +0, they compare equal so they must hash equal.
+      data[i + 0] = position.data[i] + 0.f;
+      data[i + 3] = normal.data[i] + 0.f;
+      data[i + 6] = uv.data[i] + 0.f;
+    }
   }
 
-  // get all the files, load all the png.
-  auto files = get_all_files_in_directory(directory);
-  uint32_t index = 0;
-  for (auto& file : files) {
-    std::string name = file.u8string();
-    textures.push_back(name);
-    // get the simple texture name (no extention, no path).
-    name = name.substr(name.find_last_of("\\") + 1);
-    name = name.substr(0, name.find_last_of("."));
-    // remove '_fbr', qpakman appends '_fbr' to some textures after extraction.
-    // in addition it automatically replaces os unsafe tokens with substrings
-    // e.g: '*' becomes 'star_'.
-    auto path = name + ".png";
-    auto sanitized = name;
-    string_utils::replace(sanitized, "_fbr", "");
-    loader_png_data_t* image = load_png(file.u8string().c_str(), allocator);
-    tex_map[sanitized] = { path, image, index++ };
+  bool
+  operator==(const mesh_vertex_t& other) const
+  {
+    return !memcmp(data, other.data, sizeof(data));
   }
+};
 
-  return textures;
-}
+struct mesh_vertex_hash_t {
+  size_t
+  operator()(const mesh_vertex_t& vertex) const
+  {
+    uint32_t bits[9];
+    memcpy(bits, vertex.data, sizeof(bits));
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint32_t i = 0; i < 9; ++i)
+      hash = (hash ^ bits[i]) * 0x100000001b3ull;
+    return (size_t)(hash ^ (hash >> 32));
+  }
+};
+
+using mesh_vertex_map_t =
+  std::unordered_map<mesh_vertex_t, uint32_t, mesh_vertex_hash_t>;
 
 static
 void
@@ -135,6 +216,8 @@ populate_scene(
   texture_map_t& tex_map,
   const allocator_t* allocator)
 {
+  trace::scope_t scope("populate_scene");
+
   {
     cvector_setup(
       &scene->texture_repo,
@@ -205,6 +288,11 @@ populate_scene(
       allocator);
     cvector_resize(&scene->mesh_repo, scene->material_repo.size);
 
+    uint32_t corner_total = 0, vertex_total = 0;
+    mesh_vertex_map_t lookup;
+    std::vector<mesh_vertex_t> unique;
+    std::vector<uint32_t> mesh_indices;
+
     for (auto& entry : tex_map) {
       uint32_t i = entry.second.index;
       mesh_t *mesh = cvector_as(&scene->mesh_repo, i, mesh_t);
@@ -213,8 +301,27 @@ populate_scene(
       // get the faces that share this index texture-material.
       auto& face_indices = entry.second.indices;
       uint32_t face_count = face_indices.size();
-      uint32_t vertices_count = face_count * 3;
-      uint32_t sizef3 = sizeof(float) * 3;
+      uint32_t corner_count = face_count * 3;
+
+      // the corners the faces share after welding collapse into one vertex.
+      lookup.clear();
+      lookup.reserve(corner_count);
+      unique.clear();
+      mesh_indices.resize(corner_count);
+      for (uint32_t k = 0; k < face_count; ++k) {
+        auto& face = map_faces[face_indices[k]];
+        for (uint32_t c = 0; c < 3; ++c) {
+          mesh_vertex_t vertex(face.face.points[c], face.normal, face.uv[c]);
+          auto inserted = lookup.emplace(vertex, (uint32_t)unique.size());
+          if (inserted.second)
+            unique.push_back(vertex);
+          mesh_indices[k * 3 + c] = inserted.first->second;
+        }
+      }
+
+      uint32_t vertices_count = unique.size();
+      corner_total += corner_count;
+      vertex_total += vertices_count;
 
       cvector_setup(&mesh->vertices, get_type_data(float), 0, allocator);
       cvector_resize(&mesh->vertices, vertices_count * 3);
@@ -222,39 +329,31 @@ populate_scene(
       cvector_resize(&mesh->normals, vertices_count * 3);
       cvector_setup(&mesh->uvs, get_type_data(float), 0, allocator);
       cvector_resize(&mesh->uvs, vertices_count * 3);
-      memset(mesh->uvs.data, 0, sizeof(float) * vertices_count * 3);
       cvector_setup(&mesh->indices, get_type_data(uint32_t), 0, allocator);
-      cvector_resize(&mesh->indices, vertices_count);
+      cvector_resize(&mesh->indices, corner_count);
       mesh->materials.used = 1;
       mesh->materials.indices[0] = i;
 
       // copy the data into the mesh.
-      uint32_t verti = 0, indexi = 0;
       float *vertices = (float *)mesh->vertices.data;
       float *normals = (float *)mesh->normals.data;
       float *uvs = (float *)mesh->uvs.data;
-      uint32_t *indices = (uint32_t *)mesh->indices.data;
-      for (uint32_t k = 0; k < face_count; ++k) {
-        auto& face = map_faces[face_indices[k]];
-        point3f* points = face.face.points;
-        memcpy(vertices + (verti + 0) * 3, points[0].data, sizef3);
-        memcpy(vertices + (verti + 1) * 3, points[1].data, sizef3);
-        memcpy(vertices + (verti + 2) * 3, points[2].data, sizef3);
-        memcpy(normals + (verti + 0) * 3, face.normal.data, sizef3);
-        memcpy(normals + (verti + 1) * 3, face.normal.data, sizef3);
-        memcpy(normals + (verti + 2) * 3, face.normal.data, sizef3);
-        memcpy(uvs + (verti + 0) * 3, face.uv[0].data, sizef3);
-        memcpy(uvs + (verti + 1) * 3, face.uv[1].data, sizef3);
-        memcpy(uvs + (verti + 2) * 3, face.uv[2].data, sizef3);
-
-        indices[indexi + 0] = verti + 0;
-        indices[indexi + 1] = verti + 1;
-        indices[indexi + 2] = verti + 2;
-
-        indexi += 3;
-        verti += 3;
+      for (uint32_t k = 0; k < vertices_count; ++k) {
+        memcpy(vertices + k * 3, unique[k].data + 0, sizeof(float) * 3);
+        memcpy(normals + k * 3, unique[k].data + 3, sizeof(float) * 3);
+        memcpy(uvs + k * 3, unique[k].data + 6, sizeof(float) * 3);
       }
+      if (corner_count)
+        memcpy(
+          mesh->indices.data,
+          mesh_indices.data(),
+          sizeof(uint32_t) * corner_count);
     }
+
+    if (corner_total)
+      printf("vertices: %u for %u corners (%.1f%% fewer).\n",
+        vertex_total, corner_total,
+        100.0 * (corner_total - vertex_total) / corner_total);
   }
 
   {
@@ -386,34 +485,61 @@ map_to_meshes(
   const char* scene_file,
   loader_map_data_t* map_data,
   texture_map_t& tex_map,
+  topology::polygon_engine_t engine,
+  thread_pool_t* pool,
   const allocator_t* allocator)
 {
   // we only need the width and height
   std::unordered_map<std::string, topology::texture_info_t> textures_info;
   for (auto& entry : tex_map)
     textures_info[entry.first] = {
-      entry.second.png_data->width, entry.second.png_data->height };
+      entry.second.miptex->width, entry.second.miptex->height };
 
-  std::vector<topology::poly_brush_t> poly_brushes;
-  for (uint32_t i = 0; i < map_data->world.brush_count; ++i) {
-    const topology::brush_t brush(map_data->world.brushes + i, textures_info);
-    poly_brushes.emplace_back(&brush);
+  // the brushes are independent until they are welded, each one is converted
+  // into its own slot so the order does not depend on the scheduling.
+  std::vector<topology::poly_brush_t> poly_brushes(map_data->world.brush_count);
+  {
+    trace::scope_t scope("brush_csg");
+    auto convert = [&](uint32_t i) {
+      const topology::brush_t brush(
+        map_data->world.brushes + i, textures_info);
+      poly_brushes[i] = topology::poly_brush_t(&brush, engine);
+    };
+
+    if (pool)
+      pool->parallel_for("brush_csg", map_data->world.brush_count, convert);
+    else
+      for (uint32_t i = 0; i < map_data->world.brush_count; ++i)
+        convert(i);
+
+    uint32_t open_faces = 0;
+    for (auto& poly_brush : poly_brushes)
+      open_faces += poly_brush.open_faces();
+    if (open_faces)
+      printf("brushes: %u faces did not close.\n", open_faces);
   }
 
-  topology::poly_brush_t::sort_and_weld(poly_brushes);
+  {
+    trace::scope_t scope("sort_and_weld");
+    topology::poly_brush_t::sort_and_weld(poly_brushes, pool);
+  }
 
   std::vector<topology::face_t> map_faces;
-  for (uint32_t i = 0; i < poly_brushes.size(); ++i) {
-    const topology::poly_brush_t& poly_brush = poly_brushes[i];
-    std::vector<topology::face_t> faces = poly_brush.to_faces();
-
-    for (uint32_t j = 0; j < faces.size(); ++j) {
-      auto& face = faces[j];
-      if (face.texture.size())
-        tex_map[face.texture].indices.push_back(map_faces.size() + j);
-    }
+  {
+    trace::scope_t scope("triangulate");
+    for (uint32_t i = 0; i < poly_brushes.size(); ++i) {
+      const topology::poly_brush_t& poly_brush = poly_brushes[i];
+      std::vector<topology::face_t> faces = poly_brush.to_faces();
+
+      for (uint32_t j = 0; j < faces.size(); ++j) {
+        // faces whose texture is missing from the wad have no mesh.
+        auto iter = tex_map.find(faces[j].texture);
+        if (iter != tex_map.end())
+          iter->second.indices.push_back(map_faces.size() + j);
+      }
 
-    map_faces.insert(map_faces.end(), faces.begin(), faces.end());
+      map_faces.insert(map_faces.end(), faces.begin(), faces.end());
+    }
   }
 
   populate_scene(
@@ -424,28 +550,115 @@ map_to_meshes(
     allocator);
 }
 
-texture_vec_t
+////////////////////////////////////////////////////////////////////////////////
+// NOTE: the wads stay mapped between conversions, an entry is dropped once its
+// file changes.
+struct wad_texture_cache_t {
+  struct entry_t {
+    std::filesystem::file_time_type write_time;
+    std::shared_ptr<wad::wad_file_t> wad;
+  };
+
+  // null if the wad does not exist or cannot be stat'ed.
+  std::shared_ptr<wad::wad_file_t>
+  get(const std::string& wad_file)
+  {
+    std::error_code error;
+    std::string key = std::filesystem::canonical(wad_file, error).string();
+    if (error)
+      return nullptr;
+    auto write_time = std::filesystem::last_write_time(key, error);
+    if (error)
+      return nullptr;
+
+    auto iter = entries.find(key);
+    if (iter != entries.end() && iter->second.write_time != write_time) {
+      entries.erase(iter);
+      iter = entries.end();
+    }
+
+    if (iter == entries.end()) {
+      entry_t entry;
+      entry.write_time = write_time;
+      entry.wad = std::make_shared<wad::wad_file_t>(key);
+      iter = entries.emplace(key, std::move(entry)).first;
+    }
+
+    return iter->second.wad;
+  }
+
+  std::unordered_map<std::string, entry_t> entries;
+};
+
+wad_texture_cache_t*
+create_wad_texture_cache()
+{
+  return new wad_texture_cache_t;
+}
+
+void
+free_wad_texture_cache(wad_texture_cache_t* cache)
+{
+  delete cache;
+}
+////////////////////////////////////////////////////////////////////////////////
+
+std::string
+get_wad_directory(
+  const char* scene_file,
+  std::string wad_directory)
+{
+  std::string directory = scene_file;
+  auto iter = directory.find_last_of("\\/");
+  directory = directory.substr(0, iter + 1);
+  std::replace(wad_directory.begin(), wad_directory.end(), '/', '\\');
+  directory += wad_directory;
+  return directory;
+}
+
+std::string
+get_wad_file(
+  const char* scene_file,
+  std::string wad_directory)
+{
+  return get_wad_directory(scene_file, wad_directory) + ".wad";
+}
+
+bool
 map_to_bin(
   const char* scene_file,
   loader_map_data_t* map_data,
   scene_t *scene,
+  const std::string& texture_directory,
+  const conversion_context_t* context,
   const allocator_t* allocator)
 {
+  std::string wad_file = get_wad_file(scene_file, map_data->world.wad);
+  std::shared_ptr<wad::wad_file_t> wad;
+  if (context->wad_cache)
+    wad = context->wad_cache->get(wad_file);
+  else
+    wad = std::make_shared<wad::wad_file_t>(wad_file);
+
+  // without the wad every face would be dropped for lack of a texture.
+  if (!wad || !wad->is_valid()) {
+    printf("cannot read the wad file '%s'!\n", wad_file.c_str());
+    return false;
+  }
+
   texture_map_t tex_map;
-  texture_vec_t textures = load_texture_data(
-    scene_file,
-    map_data->world.wad,
-    tex_map,
-    allocator);
+  load_texture_data(*wad, collect_referenced_textures(map_data), tex_map);
 
   map_to_meshes(
     scene,
     scene_file,
     map_data,
     tex_map,
+    context->mesh_cutting ?
+      topology::polygon_engine_t::mesh : topology::polygon_engine_t::clip,
+    context->pool,
     allocator);
 
-  free_texture_data(tex_map, allocator);
-
-  return textures;
-}
\ No newline at end of file
+  return write_textures(
+    tex_map, load_palette(*wad, context), texture_directory);
+}
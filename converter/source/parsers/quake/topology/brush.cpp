@@ -8,6 +8,8 @@
  * @copyright Copyright (c) 2025
  *
  */
+#include <algorithm>
+#include <cmath>
 #include <converter/parsers/quake/string_utils.h>
 #include <converter/parsers/quake/topology/brush.h>
 #include <converter/parsers/quake/topology/edge.h>
@@ -64,7 +66,7 @@ make_cube(const float scale)
 
 brush_t::brush_t(
     const loader_map_brush_data_t* brush,
-    std::unordered_map<std::string, texture_info_t>& textures_info)
+    const std::unordered_map<std::string, texture_info_t>& textures_info)
 {
   for (uint32_t i = 0, count = brush->face_count; i < count; ++i) {
     int32_t* data = brush->faces[i].data;
@@ -86,139 +88,695 @@ brush_t::brush_t(
 
     std::string texture = string_utils::get_sanitized(brush->faces[i].texture);
 
-    // read the texture width/height
+    // read the texture width/height, the map is shared between threads.
     texture_info_t texture_info;
-    if (texture.size() != 0)
-        texture_info = textures_info[texture];
+    auto iter = textures_info.find(texture);
+    if (iter != textures_info.end())
+        texture_info = iter->second;
+
+    plane_t plane;
+    plane.face = face;
+    plane.normal = normal;
+    plane.texture = texture;
+    plane.texture_data = texture_data;
+    plane.texture_info = texture_info;
+    plane.exact = make_exact_plane(data + 0, data + 6, data + 3, normal);
+    plane.projection = get_texture_projection(
+      texture_data, texture_info, normal);
+    planes.push_back(plane);
+  }
+}
+
+brush_t::brush_t(std::vector<plane_t> planes)
+  : planes(std::move(planes))
+{
+  for (auto& plane : this->planes)
+    plane.projection = get_texture_projection(
+      plane.texture_data, plane.texture_info, plane.normal);
+}
+
+// the mesh engine cuts a closed mesh, the cube to begin with, by one plane
+// at a time. Planes are numbered with the cube's 6 first and the brush planes
+// after them, a face is the part of one plane inside the others.
+static constexpr uint32_t s_cube_plane_count = 6;
+static constexpr uint32_t s_mesh_none = UINT32_MAX;
+
+struct mesh_vertex_t {
+  point3f point;
+  // the planes the vertex was cut from, only read for exact brushes.
+  uint32_t planes[3];
+};
+
+struct mesh_face_t {
+  uint32_t plane;
+  // the loop and the plane across the edge out of each of its vertices.
+  small_vector_t<uint32_t, 16> vertices;
+  small_vector_t<uint32_t, 16> neighbours;
+};
+
+// the vertex made where an edge crosses the cutting plane, listed under the
+// edge's vertex in front of the plane.
+struct mesh_crossing_t {
+  uint32_t back;
+  uint32_t vertex;
+  uint32_t next;
+};
+
+struct mesh_t {
+  std::vector<mesh_vertex_t> vertices;
+  std::vector<mesh_face_t> faces;
+};
+
+// the buffers to_polygons() cycles through, they are kept per thread so their
+// capacity carries over from one brush to the next.
+struct to_polygons_scratch_t {
+  std::vector<polygon_t> stone;
+  std::vector<polygon_t> cut_stone;
+  std::vector<edge_t> intersection;
+  // the exact plane of the poly each intersection edge was cut from.
+  std::vector<const exact_plane_t*> intersection_planes;
+  polygon_t face;
+  std::vector<mesh_vertex_t> vertices;
+  std::vector<mesh_face_t> faces;
+  std::vector<mesh_face_t> cut_faces;
+  // per vertex, its side of the cutting plane, the head of its crossings and
+  // the next vertex along the new face.
+  std::vector<int8_t> sides;
+  std::vector<uint32_t> crossing_heads;
+  std::vector<mesh_crossing_t> crossings;
+  std::vector<uint32_t> cap_next;
+  std::vector<uint32_t> cap_neighbours;
+  // per plane, whether its face was cut away whole by the current plane.
+  std::vector<uint8_t> dropped;
+  // make_face() endpoint buckets, chained through 'chain_next'.
+  std::vector<uint32_t> chain_heads;
+  std::vector<uint32_t> chain_next;
+  std::vector<uint8_t> chain_used;
+};
+
+static thread_local to_polygons_scratch_t tl_scratch;
+
+// assigns into the slots left over from a previous plane before growing.
+template<typename T>
+static
+T&
+next_slot(std::vector<T>& slots, uint32_t& used)
+{
+  if (used == slots.size())
+    slots.emplace_back();
+  return slots[used++];
+}
+
+std::vector<polygon_t>
+brush_t::to_polygons(polygon_engine_t engine, uint32_t* open_faces) const
+{
+  if (open_faces)
+    *open_faces = 0;
+  if (engine == polygon_engine_t::mesh)
+    return cut_mesh_polygons(open_faces);
+  return clip_polygons(open_faces);
+}
 
-    planes.push_back({ face, normal, texture, texture_data, texture_info });
+// the cube's planes as exact planes, 'normal . x = scale / 2' with an axis
+// normal. Every cube face knows the planes of its edges, the faces of a .map
+// brush are then cut from it exactly.
+static exact_plane_t s_cube_planes[s_cube_plane_count];
+
+static
+std::vector<polygon_t>
+make_exact_cube(const float scale = 8192.f)
+{
+  std::vector<polygon_t> cube = make_cube(scale);
+  for (uint32_t i = 0; i < 6; ++i) {
+    exact_plane_t& plane = s_cube_planes[i];
+    for (uint32_t k = 0; k < 3; ++k)
+      plane.normal[k] = (double)lroundf(cube[i].normal.data[k]);
+    plane.distance = 0.5 * scale;
+    plane.valid = true;
+  }
+
+  // the neighbour across an edge is the other face both its points are on.
+  for (uint32_t i = 0; i < 6; ++i) {
+    polygon_t& face = cube[i];
+    face.exact_plane = s_cube_planes + i;
+    for (uint32_t j = 0, count = face.points.size(); j < count; ++j) {
+      const point3f& p0 = face.points[j];
+      const point3f& p1 = face.points[(j + 1) % count];
+      const exact_plane_t* neighbour = nullptr;
+      for (uint32_t k = 0; k < 6 && !neighbour; ++k) {
+        const vector3f& normal = cube[k].normal;
+        if (
+          k != i &&
+          fabsf(dot_product_v3f(&normal, &p0) - 0.5f * scale) < 0.5f &&
+          fabsf(dot_product_v3f(&normal, &p1) - 0.5f * scale) < 0.5f)
+          neighbour = s_cube_planes + k;
+      }
+      assert(neighbour && "cube edge without a neighbour face!");
+      face.exact_edges.push_back(neighbour);
+    }
   }
+
+  return cube;
+}
+
+static
+const std::vector<polygon_t>&
+get_exact_cube()
+{
+  static const std::vector<polygon_t> s_cube = make_exact_cube();
+  return s_cube;
 }
 
 std::vector<polygon_t>
-brush_t::to_polygons() const
+brush_t::clip_polygons(uint32_t* open_faces) const
 {
-  std::vector<polygon_t> stone = make_cube();
+  const std::vector<polygon_t>& s_cube = get_exact_cube();
+
+  // a brush read from a .map classifies its points exactly, the planes of one
+  // brush are either all exact or all float so the faces that share an edge
+  // agree on its points.
+  bool exact = std::all_of(
+    planes.begin(), planes.end(),
+    [](const plane_t& plane) { return plane.exact.valid; });
+
+  to_polygons_scratch_t& scratch = tl_scratch;
+  auto& stone = scratch.stone;
+  auto& cut_stone = scratch.cut_stone;
+  uint32_t stone_count = 0;
+  for (auto& face : s_cube) {
+    polygon_t& slot = next_slot(stone, stone_count);
+    slot = face;
+    if (!exact) {
+      slot.exact_plane = nullptr;
+      slot.exact_edges.clear();
+    }
+  }
 
   for (auto& brush_plane : planes) {
-    std::list<edge_t> intersection;
-    std::vector<polygon_t> cut_stone;
+    auto& intersection = scratch.intersection;
+    auto& intersection_planes = scratch.intersection_planes;
+    intersection.clear();
+    intersection_planes.clear();
+    uint32_t cut_count = 0;
+
+    for (uint32_t i = 0; i < stone_count; ++i) {
+      edge_t edge;
+      polygon_t& slot = next_slot(cut_stone, cut_count);
+      polygon_t::side_t side = stone[i].clip(
+        brush_plane, nullptr, &slot, edge);
+
+      if (side == polygon_t::side_t::back)
+        slot = stone[i];
+      else if (side == polygon_t::side_t::front)
+        --cut_count;
+      else {
+        intersection.push_back(edge);
+        intersection_planes.push_back(stone[i].exact_plane);
+      }
+    }
 
-    for (auto& face : stone) {
-      polygon_t::clip_data_t data = face.clip(brush_plane);
+    bool closed = true;
+    if (make_face(
+      brush_plane, intersection, scratch.face, &closed,
+      exact ? &intersection_planes : nullptr))
+      next_slot(cut_stone, cut_count) = scratch.face;
+    if (!closed && open_faces)
+      ++*open_faces;
 
-      if (data.back && !data.front)
-        cut_stone.push_back(*data.back);
-      else if (!data.back && data.front)
-        continue;
+    std::swap(stone, cut_stone);
+    stone_count = cut_count;
+  }
+
+  // the exact planes belong to this brush and the cube, they stay behind.
+  std::vector<polygon_t> polygons(stone.begin(), stone.begin() + stone_count);
+  for (auto& polygon : polygons) {
+    polygon.exact_plane = nullptr;
+    polygon.exact_edges.clear();
+  }
+  return polygons;
+}
+
+// the cube as a mesh, its corners are shared by the 3 faces that meet there.
+static
+mesh_t
+make_cube_mesh(const std::vector<polygon_t>& cube)
+{
+  mesh_t mesh;
+  for (uint32_t i = 0; i < s_cube_plane_count; ++i) {
+    const polygon_t& polygon = cube[i];
+    mesh_face_t face;
+    face.plane = i;
+    for (uint32_t j = 0, count = polygon.points.size(); j < count; ++j) {
+      uint32_t in = polygon.exact_edges[(j + count - 1) % count] - s_cube_planes;
+      uint32_t out = polygon.exact_edges[j] - s_cube_planes;
+      uint32_t index = 0;
+      while (
+        index < mesh.vertices.size() &&
+        !identical_points(mesh.vertices[index].point, polygon.points[j]))
+        ++index;
+      if (index == mesh.vertices.size())
+        mesh.vertices.push_back({ polygon.points[j], { i, in, out } });
+      face.vertices.push_back(index);
+      face.neighbours.push_back(out);
+    }
+    mesh.faces.push_back(face);
+  }
+  return mesh;
+}
+
+std::vector<polygon_t>
+brush_t::cut_mesh_polygons(uint32_t* open_faces) const
+{
+  const std::vector<polygon_t>& s_cube = get_exact_cube();
+  static const mesh_t s_cube_mesh = make_cube_mesh(s_cube);
+
+  to_polygons_scratch_t& scratch = tl_scratch;
+  auto& vertices = scratch.vertices;
+  auto& faces = scratch.faces;
+  auto& cut_faces = scratch.cut_faces;
+  auto& sides = scratch.sides;
+  auto& heads = scratch.crossing_heads;
+  auto& crossings = scratch.crossings;
+  auto& cap_next = scratch.cap_next;
+  auto& cap_neighbours = scratch.cap_neighbours;
+  auto& dropped = scratch.dropped;
+  vertices = s_cube_mesh.vertices;
+  uint32_t face_count = 0;
+  for (auto& face : s_cube_mesh.faces)
+    next_slot(faces, face_count) = face;
+
+  // brushes read from a .map classify their vertices exactly.
+  bool exact = std::all_of(
+    planes.begin(), planes.end(),
+    [](const plane_t& plane) { return plane.exact.valid; });
+  auto&& exact_plane = [&](uint32_t plane) -> const exact_plane_t& {
+    return plane < s_cube_plane_count ?
+      s_cube_planes[plane] : planes[plane - s_cube_plane_count].exact;
+  };
+
+  for (uint32_t p = 0, count = planes.size(); p < count; ++p) {
+    const plane_t& plane = planes[p];
+    const uint32_t cap = p + s_cube_plane_count;
+
+    // every vertex is classified once, 1 is in front of the plane (cut away).
+    bool front = false, back = false;
+    sides.resize(vertices.size());
+    for (uint32_t i = 0; i < vertices.size(); ++i) {
+      const mesh_vertex_t& vertex = vertices[i];
+      int32_t side;
+      if (exact)
+        side = orient_vertex(
+          plane.exact,
+          exact_plane(vertex.planes[0]),
+          exact_plane(vertex.planes[1]),
+          exact_plane(vertex.planes[2]));
       else {
-        cut_stone.push_back(*data.back);
-        intersection.push_back(*data.edge);
+        point_halfspace_classification_t classification =
+          classify_point_halfspace(&plane.face, &plane.normal, &vertex.point);
+        side =
+          classification == POINT_IN_POSITIVE_HALFSPACE ? 1 :
+          classification == POINT_IN_NEGATIVE_HALFSPACE ? -1 : 0;
       }
+      sides[i] = (int8_t)side;
+      front |= side > 0;
+      back |= side < 0;
+    }
+
+    // a plane with nothing in front of it adds no face (a repeated plane),
+    // one with nothing behind it leaves nothing of the brush.
+    if (!front)
+      continue;
+    if (!back) {
+      face_count = 0;
+      break;
     }
 
-    auto any = make_face(brush_plane, intersection);
-    if (any.has_value())
-      cut_stone.push_back(*any);
+    heads.assign(vertices.size(), s_mesh_none);
+    crossings.clear();
+    dropped.assign(count + s_cube_plane_count, 0);
+
+    // an edge crossing the plane is cut once for the 2 faces that share it,
+    // the new vertex lies on both faces' planes and the cutting plane.
+    auto&& crossing = [&](
+      uint32_t a,
+      uint32_t b,
+      uint32_t face_plane,
+      uint32_t edge_plane) {
+      uint32_t front_vertex = sides[a] > 0 ? a : b;
+      uint32_t back_vertex = sides[a] > 0 ? b : a;
+      uint32_t i = heads[front_vertex];
+      for (; i != s_mesh_none; i = crossings[i].next)
+        if (crossings[i].back == back_vertex)
+          return crossings[i].vertex;
+
+      mesh_vertex_t vertex = { {}, { face_plane, edge_plane, cap } };
+      if (exact)
+        vertex.point = intersect_exact_planes(
+          exact_plane(face_plane), exact_plane(edge_plane), plane.exact);
+      else {
+        segment_t segment;
+        segment.points[0] = vertices[front_vertex].point;
+        segment.points[1] = vertices[back_vertex].point;
+        float t = 0.f;
+        classify_segment_face(
+          &plane.face, &plane.normal, &segment, &vertex.point, &t);
+      }
 
-    stone = cut_stone;
+      uint32_t index = vertices.size();
+      vertices.push_back(vertex);
+      sides.push_back(0);
+      crossings.push_back({ back_vertex, index, heads[front_vertex] });
+      heads[front_vertex] = crossings.size() - 1;
+      return index;
+    };
+
+    // a face is kept, cut away whole or split like polygon_t::clip() does,
+    // the kept part leaves a vertex along the plane when the next one is in
+    // front of it.
+    uint32_t cut_count = 0;
+    for (uint32_t f = 0; f < face_count; ++f) {
+      const mesh_face_t& face = faces[f];
+      bool face_front = false, face_back = false;
+      for (uint32_t vertex : face.vertices) {
+        face_front |= sides[vertex] > 0;
+        face_back |= sides[vertex] < 0;
+      }
+      if (!face_front) {
+        next_slot(cut_faces, cut_count) = face;
+        continue;
+      }
+      if (!face_back) {
+        dropped[face.plane] = 1;
+        continue;
+      }
+
+      mesh_face_t& part = next_slot(cut_faces, cut_count);
+      part.plane = face.plane;
+      part.vertices.clear();
+      part.neighbours.clear();
+      for (uint32_t i = 0, size = face.vertices.size(); i < size; ++i) {
+        uint32_t a = face.vertices[i];
+        uint32_t b = face.vertices[(i + 1) % size];
+        uint32_t neighbour = face.neighbours[i];
+        if (sides[a] <= 0) {
+          part.vertices.push_back(a);
+          part.neighbours.push_back(
+            sides[a] == 0 && sides[b] > 0 ? cap : neighbour);
+        }
+        if (sides[a] * sides[b] < 0) {
+          part.vertices.push_back(crossing(a, b, face.plane, neighbour));
+          part.neighbours.push_back(sides[a] < 0 ? cap : neighbour);
+        }
+      }
+    }
+
+    // the new face runs backwards along the edges left on the plane, those of
+    // the split faces and those whose neighbour was cut away whole.
+    cap_next.assign(vertices.size(), s_mesh_none);
+    cap_neighbours.resize(vertices.size());
+    uint32_t cap_start = s_mesh_none, cap_edges = 0;
+    for (uint32_t f = 0; f < cut_count; ++f) {
+      mesh_face_t& face = cut_faces[f];
+      for (uint32_t i = 0, size = face.vertices.size(); i < size; ++i) {
+        uint32_t& neighbour = face.neighbours[i];
+        if (neighbour != cap && !dropped[neighbour])
+          continue;
+        neighbour = cap;
+        uint32_t a = face.vertices[i];
+        uint32_t b = face.vertices[(i + 1) % size];
+        cap_next[b] = a;
+        cap_neighbours[b] = face.plane;
+        cap_start = b;
+        ++cap_edges;
+      }
+    }
+
+    // the loop must use every edge, a broken one (float noise) adds no face
+    // and is counted like an open chain of the clip engine.
+    mesh_face_t& cap_face = next_slot(cut_faces, cut_count);
+    cap_face.plane = cap;
+    cap_face.vertices.clear();
+    cap_face.neighbours.clear();
+    uint32_t vertex = cap_start;
+    for (uint32_t i = 0; i < cap_edges && vertex != s_mesh_none; ++i) {
+      cap_face.vertices.push_back(vertex);
+      cap_face.neighbours.push_back(cap_neighbours[vertex]);
+      vertex = cap_next[vertex];
+    }
+    if (cap_edges && vertex != cap_start && open_faces)
+      ++*open_faces;
+    if (cap_edges < 3 || vertex != cap_start)
+      --cut_count;
+
+    std::swap(faces, cut_faces);
+    face_count = cut_count;
+  }
+
+  // the faces come out in the clip engine's order, what is left of the cube
+  // then the brush planes, wound the same way.
+  std::vector<polygon_t> polygons;
+  for (uint32_t f = 0; f < face_count; ++f) {
+    const mesh_face_t& face = faces[f];
+    polygons.emplace_back();
+    polygon_t& polygon = polygons.back();
+    if (face.plane < s_cube_plane_count) {
+      polygon = s_cube[face.plane];
+      polygon.points.clear();
+      polygon.exact_plane = nullptr;
+      polygon.exact_edges.clear();
+    } else {
+      const plane_t& plane = planes[face.plane - s_cube_plane_count];
+      polygon.normal = plane.normal;
+      polygon.texture = plane.texture;
+      polygon.texture_data = plane.texture_data;
+      polygon.texture_info = plane.texture_info;
+      polygon.projection = plane.projection;
+    }
+    for (uint32_t vertex : face.vertices)
+      polygon.points.push_back(vertices[vertex].point);
+
+    if (!polygon.sanitize()) {
+      polygons.pop_back();
+      continue;
+    }
+
+    if (face.plane < s_cube_plane_count)
+      continue;
+
+    vector3f normal;
+    ::face_t nface = { polygon.points[0], polygon.points[1], polygon.points[2] };
+    get_faces_normals(&nface, 1, &normal);
+    if (dot_product_v3f(&normal, &polygon.normal) < 0.f)
+      std::reverse(polygon.points.begin(), polygon.points.end());
   }
 
-  return stone;
+  return polygons;
 }
 
-std::optional<polygon_t>
+// make_face() buckets the edge endpoints in cells of this size. A point closer
+// than 'cell / 4' (the identical_points tolerance) to a query is always in one
+// of the 8 cells around the query.
+static constexpr float s_chain_cell = 1.f / 8.f;
+static constexpr float s_chain_reach2 = 1.f / (32.f * 32.f);
+static constexpr uint32_t s_chain_end = UINT32_MAX;
+// below this many edges scanning all of them beats filling the buckets.
+static constexpr uint32_t s_chain_linear = 16;
+
+// the endpoint closest to 'point', endpoints are numbered 'edge * 2 + end'.
+// Ties go to the lowest endpoint, like a scan of the edges in order would. No
+// buckets ('heads' empty) means a plain scan.
+static
+uint32_t
+closest_endpoint(
+  const point3f& point,
+  const std::vector<edge_t>& edges,
+  const std::vector<uint32_t>& heads,
+  const std::vector<uint32_t>& next,
+  const std::vector<uint8_t>& used)
+{
+  float best = FLT_MAX;
+  uint32_t best_end = s_chain_end;
+  auto consider = [&](uint32_t end) {
+    if (used[end >> 1])
+      return;
+    float distance = distance_points_squared(
+      point, edges[end >> 1].points[end & 1]);
+    if (distance < best || (distance == best && end < best_end)) {
+      best = distance;
+      best_end = end;
+    }
+  };
+
+  if (heads.empty()) {
+    for (uint32_t end = 0, count = edges.size() * 2; end < count; ++end)
+      consider(end);
+    return best_end;
+  }
+
+  const uint32_t mask = (uint32_t)heads.size() - 1;
+  const float scale = 1.f / s_chain_cell;
+  int32_t base[3];
+  for (uint32_t i = 0; i < 3; ++i)
+    base[i] = (int32_t)floorf(point.data[i] * scale - 0.5f);
+
+  for (int32_t x = 0; x < 2; ++x)
+    for (int32_t y = 0; y < 2; ++y)
+      for (int32_t z = 0; z < 2; ++z) {
+        uint32_t bucket =
+          hash_cell(base[0] + x, base[1] + y, base[2] + z) & mask;
+        for (uint32_t end = heads[bucket]; end != s_chain_end; end = next[end])
+          consider(end);
+      }
+
+  // anything outside the 8 cells is farther than reach, past it (a gap in the
+  // chain) only a full scan knows which endpoint is the closest.
+  if (best < s_chain_reach2)
+    return best_end;
+
+  best = FLT_MAX;
+  best_end = s_chain_end;
+  for (uint32_t end = 0, count = edges.size() * 2; end < count; ++end)
+    consider(end);
+  return best_end;
+}
+
+bool
 brush_t::make_face(
   const plane_t& plane,
-  const std::list<edge_t>& edge_list)
+  std::vector<edge_t>& edges,
+  polygon_t& polygon,
+  bool* closed,
+  std::vector<const exact_plane_t*>* edge_planes)
 {
-  std::list<edge_t> edges = edge_list;
+  // the face is exact when the plane and every edge's source plane are.
+  bool exact =
+    plane.exact.valid &&
+    edge_planes &&
+    edge_planes->size() == edges.size() &&
+    std::all_of(
+      edge_planes->begin(), edge_planes->end(),
+      [](const exact_plane_t* edge_plane) { return edge_plane != nullptr; });
 
   {
     // strip collapsed edges
-    auto iter = edges.begin();
-    while (iter != edges.end()) {
-      if (!valid_edge(*iter))
-        edges.erase(iter++);
-      else
-        ++iter;
+    uint32_t kept = 0;
+    for (uint32_t i = 0, count = edges.size(); i < count; ++i) {
+      if (!valid_edge(edges[i]))
+        continue;
+      if (exact)
+        (*edge_planes)[kept] = (*edge_planes)[i];
+      edges[kept++] = edges[i];
     }
+    edges.resize(kept);
+    if (edge_planes)
+      edge_planes->resize(exact ? kept : 0);
 
     // erroneous generation, early out
-    if (edges.size() < 2)
-      return std::nullopt;
+    if (edges.size() < 2) {
+      edges.clear();
+      if (edge_planes)
+        edge_planes->clear();
+      return false;
+    }
+  }
+
+  // bucket every endpoint by its cell, each step then only looks at the
+  // endpoints around the end of the chain. Small faces are simply scanned.
+  to_polygons_scratch_t& scratch = tl_scratch;
+  auto& heads = scratch.chain_heads;
+  auto& next = scratch.chain_next;
+  auto& used = scratch.chain_used;
+  heads.clear();
+  next.clear();
+  used.assign(edges.size(), 0);
+  if (edges.size() > s_chain_linear) {
+    uint32_t size = 16;
+    while (size < edges.size() * 4)
+      size <<= 1;
+    heads.assign(size, s_chain_end);
+    next.resize(edges.size() * 2);
+
+    const float scale = 1.f / s_chain_cell;
+    for (uint32_t end = 0, count = edges.size() * 2; end < count; ++end) {
+      const point3f& point = edges[end >> 1].points[end & 1];
+      uint32_t bucket = hash_cell(
+        (int32_t)floorf(point.data[0] * scale),
+        (int32_t)floorf(point.data[1] * scale),
+        (int32_t)floorf(point.data[2] * scale)) & (size - 1);
+      next[end] = heads[bucket];
+      heads[bucket] = end;
+    }
   }
 
   // connect the edges that will make up the new polygon
-  polygon_t polygon;
+  polygon.points.clear();
   polygon.normal = plane.normal;
   polygon.texture = plane.texture;
   polygon.texture_data = plane.texture_data;
   polygon.texture_info = plane.texture_info;
-  auto iter = edges.begin();
-  polygon.points.push_back(iter->points[0]);
-  polygon.points.push_back(iter->points[1]);
-  edges.erase(iter++);
-  point3f* back = &polygon.points.back();
-
-  // closest distance and early out when closed, it is a more robust approach
-  float min_distance;
-  uint32_t min_distance_i;
-  bool closed = false;
-  while (!closed) {
-    auto iter = edges.begin();
-    auto copy = iter;
-    min_distance = FLT_MAX;
-    min_distance_i = 2;
-    for (; iter != edges.end(); ++iter) {
-      float distances[2];
-      distances[0] = distance_points(*back, iter->points[0]);
-      distances[1] = distance_points(*back, iter->points[1]);
-      if (min_distance > distances[0]) {
-        min_distance = distances[0];
-        min_distance_i = 0;
-        copy = iter;
-      }
-
-      if (min_distance > distances[1]) {
-        min_distance = distances[1];
-        min_distance_i = 1;
-        copy = iter;
-      }
+  polygon.projection = plane.projection;
+  polygon.exact_plane = exact ? &plane.exact : nullptr;
+  polygon.exact_edges.clear();
+  polygon.points.push_back(edges[0].points[0]);
+  polygon.points.push_back(edges[0].points[1]);
+  used[0] = 1;
+
+  // the edge out of every point, the one that closes the loop comes last.
+  if (exact)
+    polygon.exact_edges.push_back((*edge_planes)[0]);
+
+  // closest endpoint and early out when closed, it is a more robust approach
+  bool loop_closed = false;
+  for (uint32_t remaining = edges.size() - 1; remaining; --remaining) {
+    uint32_t end = closest_endpoint(
+      polygon.points.back(), edges, heads, next, used);
+    assert(end != s_chain_end);
+    used[end >> 1] = 1;
+    if (exact)
+      polygon.exact_edges.push_back((*edge_planes)[end >> 1]);
+
+    const point3f& other = edges[end >> 1].points[(end & 1) ^ 1];
+    if (identical_points(other, polygon.points.front())) {
+      loop_closed = true;
+      break;
     }
-
-    if (min_distance_i == 0) {
-      if (identical_points(copy->points[1], polygon.points.front()))
-        closed = true;
-      else
-        polygon.points.push_back(copy->points[1]);
-    } else if (min_distance_i == 1) {
-      if (identical_points(copy->points[0], polygon.points.front()))
-        closed = true;
-      else
-        polygon.points.push_back(copy->points[0]);
-    } else
-      assert(min_distance_i != 2);
-
-    edges.erase(copy);
-    closed = edges.empty() ? true : closed;
-    back = &polygon.points.back();
+    polygon.points.push_back(other);
   }
 
   edges.clear();
+  if (edge_planes)
+    edge_planes->clear();
+
+  // an open chain has no edge back to its first point.
+  if (polygon.exact_edges.size() != polygon.points.size()) {
+    polygon.exact_plane = nullptr;
+    polygon.exact_edges.clear();
+  }
+
+  if (closed)
+    *closed = loop_closed;
 
   if (!polygon.sanitize())
-    return std::nullopt;
+    return false;
 
   // flip the ordering if needed
   vector3f normal;
   ::face_t nface = { polygon.points[0], polygon.points[1], polygon.points[2] };
   get_faces_normals(&nface, 1, &normal);
 
-  if (dot_product_v3f(&normal, &polygon.normal) < 0.f)
+  if (dot_product_v3f(&normal, &polygon.normal) < 0.f) {
     std::reverse(polygon.points.begin(), polygon.points.end());
+    // the edge out of a point is now the one that came into it.
+    if (polygon.exact_plane) {
+      std::reverse(polygon.exact_edges.begin(), polygon.exact_edges.end());
+      std::rotate(
+        polygon.exact_edges.begin(),
+        polygon.exact_edges.begin() + 1,
+        polygon.exact_edges.end());
+    }
+  }
 
-  return polygon;
+  return true;
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,424 @@
+/**
+ * @file exact.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <converter/parsers/quake/topology/exact.h>
+
+
+namespace topology {
+
+// the .map coordinates the exact planes are valid for, the integer normal and
+// distance then stay below 2^53.
+static constexpr int64_t s_coordinate_limit = 65536;
+
+// error bounds of the double evaluations, relative to the same expression
+// evaluated on absolute values. Deliberately loose, a failed filter only costs
+// the exact evaluation.
+static constexpr double s_point_bound = 8.0 * DBL_EPSILON;
+static constexpr double s_normals_bound = 8.0 * DBL_EPSILON;
+static constexpr double s_vertex_bound = 32.0 * DBL_EPSILON;
+
+// integer expressions whose terms add up to less than this are evaluated
+// exactly in double, no rounding happens along the way.
+static constexpr double s_exact_integers = 4503599627370496.0;
+
+// the largest expansion orient_vertex builds is 192 components.
+static constexpr int32_t s_max_expansion = 256;
+
+static
+int64_t
+gcd(int64_t a, int64_t b)
+{
+  a = std::llabs(a);
+  b = std::llabs(b);
+  while (b) {
+    int64_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+exact_plane_t
+make_exact_plane(
+  const int32_t* p0,
+  const int32_t* p1,
+  const int32_t* p2,
+  const vector3f& normal)
+{
+  exact_plane_t plane;
+  for (uint32_t i = 0; i < 3; ++i)
+    if (
+      std::llabs(p0[i]) > s_coordinate_limit ||
+      std::llabs(p1[i]) > s_coordinate_limit ||
+      std::llabs(p2[i]) > s_coordinate_limit)
+      return plane;
+
+  int64_t a[3], b[3];
+  for (uint32_t i = 0; i < 3; ++i) {
+    a[i] = (int64_t)p1[i] - p0[i];
+    b[i] = (int64_t)p2[i] - p0[i];
+  }
+
+  int64_t n[3] = {
+    a[1] * b[2] - a[2] * b[1],
+    a[2] * b[0] - a[0] * b[2],
+    a[0] * b[1] - a[1] * b[0] };
+  int64_t divisor = gcd(gcd(n[0], n[1]), n[2]);
+  if (!divisor)
+    return plane;
+
+  for (uint32_t i = 0; i < 3; ++i)
+    n[i] /= divisor;
+
+  // the integer normal follows the winding the float normal was computed with.
+  double agree =
+    n[0] * (double)normal.data[0] +
+    n[1] * (double)normal.data[1] +
+    n[2] * (double)normal.data[2];
+  if (agree < 0.0)
+    for (uint32_t i = 0; i < 3; ++i)
+      n[i] = -n[i];
+
+  for (uint32_t i = 0; i < 3; ++i)
+    plane.normal[i] = (double)n[i];
+  plane.distance = (double)(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+  plane.valid = true;
+  return plane;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// floating point expansions, see Shewchuk's 'Adaptive Precision Floating-Point
+// Arithmetic and Fast Robust Geometric Predicates'. An expansion is a sum of
+// non overlapping doubles ordered by increasing magnitude, its sign is the sign
+// of its last component.
+static
+void
+two_sum(double a, double b, double& x, double& y)
+{
+  x = a + b;
+  double b_virtual = x - a;
+  double a_virtual = x - b_virtual;
+  y = (a - a_virtual) + (b - b_virtual);
+}
+
+static
+void
+two_product(double a, double b, double& x, double& y)
+{
+  x = a * b;
+  y = std::fma(a, b, -x);
+}
+
+// h = e + b, h holds up to elen + 1 components.
+static
+int32_t
+grow_expansion(int32_t elen, const double* e, double b, double* h)
+{
+  int32_t hlen = 0;
+  double q = b;
+  for (int32_t i = 0; i < elen; ++i) {
+    double sum, error;
+    two_sum(q, e[i], sum, error);
+    q = sum;
+    if (error != 0.0)
+      h[hlen++] = error;
+  }
+  if (q != 0.0 || hlen == 0)
+    h[hlen++] = q;
+  return hlen;
+}
+
+// h = e + f, h holds up to elen + flen components.
+static
+int32_t
+sum_expansion(
+  int32_t elen,
+  const double* e,
+  int32_t flen,
+  const double* f,
+  double* h)
+{
+  double buffer[s_max_expansion];
+  assert(elen + flen <= s_max_expansion);
+
+  int32_t hlen = elen;
+  for (int32_t i = 0; i < elen; ++i)
+    h[i] = e[i];
+  for (int32_t i = 0; i < flen; ++i) {
+    int32_t length = grow_expansion(hlen, h, f[i], buffer);
+    for (int32_t j = 0; j < length; ++j)
+      h[j] = buffer[j];
+    hlen = length;
+  }
+  return hlen;
+}
+
+// h = e * b, h holds up to 2 * elen components.
+static
+int32_t
+scale_expansion(int32_t elen, const double* e, double b, double* h)
+{
+  int32_t hlen = 0;
+  double q, error;
+  two_product(e[0], b, q, error);
+  if (error != 0.0)
+    h[hlen++] = error;
+
+  for (int32_t i = 1; i < elen; ++i) {
+    double product, product_error, sum;
+    two_product(e[i], b, product, product_error);
+    two_sum(q, product_error, sum, error);
+    if (error != 0.0)
+      h[hlen++] = error;
+    // |product| >= |sum|, a fast two sum would do.
+    two_sum(product, sum, q, error);
+    if (error != 0.0)
+      h[hlen++] = error;
+  }
+
+  if (q != 0.0 || hlen == 0)
+    h[hlen++] = q;
+  return hlen;
+}
+
+static
+int32_t
+sign(int32_t length, const double* e)
+{
+  double value = e[length - 1];
+  return value > 0.0 ? 1 : (value < 0.0 ? -1 : 0);
+}
+
+static
+int32_t
+sign(double value)
+{
+  return value > 0.0 ? 1 : (value < 0.0 ? -1 : 0);
+}
+
+struct expansion_t {
+  int32_t length = 0;
+  double components[s_max_expansion];
+};
+
+// a * b - c * d, exactly.
+static
+void
+exact_cross_term(double a, double b, double c, double d, expansion_t& result)
+{
+  double left[2], right[2];
+  two_product(a, b, left[1], left[0]);
+  two_product(-c, d, right[1], right[0]);
+  result.length = sum_expansion(2, left, 2, right, result.components);
+}
+
+static
+void
+exact_cross(const double* a, const double* b, expansion_t* result)
+{
+  exact_cross_term(a[1], b[2], a[2], b[1], result[0]);
+  exact_cross_term(a[2], b[0], a[0], b[2], result[1]);
+  exact_cross_term(a[0], b[1], a[1], b[0], result[2]);
+}
+
+// v[0] * e[0] + v[1] * e[1] + v[2] * e[2], exactly.
+static
+void
+exact_dot(const double* v, const expansion_t* e, expansion_t& result)
+{
+  expansion_t scaled, partial;
+  result.length = 1;
+  result.components[0] = 0.0;
+  for (uint32_t i = 0; i < 3; ++i) {
+    scaled.length = scale_expansion(
+      e[i].length, e[i].components, v[i], scaled.components);
+    partial.length = sum_expansion(
+      result.length, result.components,
+      scaled.length, scaled.components,
+      partial.components);
+    result = partial;
+  }
+}
+////////////////////////////////////////////////////////////////////////////////
+
+int32_t
+orient_point(const exact_plane_t& plane, const point3f& point)
+{
+  assert(plane.valid);
+  const double* n = plane.normal;
+  double p[3] = { point.data[0], point.data[1], point.data[2] };
+
+  double value = n[0] * p[0] + n[1] * p[1] + n[2] * p[2] - plane.distance;
+  double magnitude =
+    fabs(n[0] * p[0]) + fabs(n[1] * p[1]) + fabs(n[2] * p[2]) +
+    fabs(plane.distance);
+  if (fabs(value) > s_point_bound * magnitude)
+    return sign(value);
+
+  double terms[7];
+  two_product(n[0], p[0], terms[1], terms[0]);
+  two_product(n[1], p[1], terms[3], terms[2]);
+  two_product(n[2], p[2], terms[5], terms[4]);
+  double e[8], f[8];
+  int32_t length = grow_expansion(2, terms, terms[2], e);
+  length = grow_expansion(length, e, terms[3], f);
+  length = grow_expansion(length, f, terms[4], e);
+  length = grow_expansion(length, e, terms[5], f);
+  length = grow_expansion(length, f, -plane.distance, e);
+  return sign(length, e);
+}
+
+int32_t
+orient_normals(
+  const exact_plane_t& plane0,
+  const exact_plane_t& plane1,
+  const exact_plane_t& plane2)
+{
+  const double* a = plane0.normal;
+  const double* b = plane1.normal;
+  const double* c = plane2.normal;
+
+  double det =
+    a[0] * (b[1] * c[2] - b[2] * c[1]) +
+    a[1] * (b[2] * c[0] - b[0] * c[2]) +
+    a[2] * (b[0] * c[1] - b[1] * c[0]);
+  double magnitude =
+    fabs(a[0]) * (fabs(b[1] * c[2]) + fabs(b[2] * c[1])) +
+    fabs(a[1]) * (fabs(b[2] * c[0]) + fabs(b[0] * c[2])) +
+    fabs(a[2]) * (fabs(b[0] * c[1]) + fabs(b[1] * c[0]));
+  if (
+    fabs(det) > s_normals_bound * magnitude ||
+    magnitude < s_exact_integers)
+    return sign(det);
+
+  expansion_t cross[3], result;
+  exact_cross(b, c, cross);
+  exact_dot(a, cross, result);
+  return sign(result.length, result.components);
+}
+
+int32_t
+orient_vertex(
+  const exact_plane_t& plane,
+  const exact_plane_t& plane0,
+  const exact_plane_t& plane1,
+  const exact_plane_t& plane2)
+{
+  // the vertex is N / det, N = d0 (n1 x n2) + d1 (n2 x n0) + d2 (n0 x n1) and
+  // det = n0 . (n1 x n2). sign(n . N / det - d) = sign(n . N - d det) sign(det).
+  int32_t det_sign = orient_normals(plane0, plane1, plane2);
+  assert(det_sign != 0 && "the planes do not meet at a single point!");
+
+  const exact_plane_t* planes[3] = { &plane0, &plane1, &plane2 };
+  const double* n = plane.normal;
+
+  {
+    double value = 0.0, magnitude = 0.0, det = 0.0, det_magnitude = 0.0;
+    for (uint32_t i = 0; i < 3; ++i) {
+      const double* a = planes[(i + 1) % 3]->normal;
+      const double* b = planes[(i + 2) % 3]->normal;
+      double c[3] = {
+        a[1] * b[2] - a[2] * b[1],
+        a[2] * b[0] - a[0] * b[2],
+        a[0] * b[1] - a[1] * b[0] };
+      double c_magnitude[3] = {
+        fabs(a[1] * b[2]) + fabs(a[2] * b[1]),
+        fabs(a[2] * b[0]) + fabs(a[0] * b[2]),
+        fabs(a[0] * b[1]) + fabs(a[1] * b[0]) };
+      double d = planes[i]->distance;
+      for (uint32_t k = 0; k < 3; ++k) {
+        value += n[k] * d * c[k];
+        magnitude += fabs(n[k] * d) * c_magnitude[k];
+      }
+
+      if (i == 0) {
+        const double* n0 = plane0.normal;
+        for (uint32_t k = 0; k < 3; ++k) {
+          det += n0[k] * c[k];
+          det_magnitude += fabs(n0[k]) * c_magnitude[k];
+        }
+      }
+    }
+
+    value -= plane.distance * det;
+    magnitude += fabs(plane.distance) * det_magnitude;
+    if (
+      fabs(value) > s_vertex_bound * magnitude ||
+      magnitude < s_exact_integers)
+      return sign(value) * det_sign;
+  }
+
+  expansion_t total, scaled, partial;
+  total.length = 1;
+  total.components[0] = 0.0;
+  for (uint32_t i = 0; i < 3; ++i) {
+    const double* a = planes[(i + 1) % 3]->normal;
+    const double* b = planes[(i + 2) % 3]->normal;
+    expansion_t cross[3], dot;
+    exact_cross(a, b, cross);
+
+    // d_i (n . c_i), and for the first cross product -d det as well.
+    exact_dot(n, cross, dot);
+    scaled.length = scale_expansion(
+      dot.length, dot.components, planes[i]->distance, scaled.components);
+    partial.length = sum_expansion(
+      total.length, total.components,
+      scaled.length, scaled.components,
+      partial.components);
+    total = partial;
+
+    if (i == 0) {
+      exact_dot(plane0.normal, cross, dot);
+      scaled.length = scale_expansion(
+        dot.length, dot.components, -plane.distance, scaled.components);
+      partial.length = sum_expansion(
+        total.length, total.components,
+        scaled.length, scaled.components,
+        partial.components);
+      total = partial;
+    }
+  }
+
+  return sign(total.length, total.components) * det_sign;
+}
+
+point3f
+intersect_exact_planes(
+  const exact_plane_t& plane0,
+  const exact_plane_t& plane1,
+  const exact_plane_t& plane2)
+{
+  const exact_plane_t* planes[3] = { &plane0, &plane1, &plane2 };
+  double point[3] = { 0.0, 0.0, 0.0 };
+  double det = 0.0;
+  for (uint32_t i = 0; i < 3; ++i) {
+    const double* a = planes[(i + 1) % 3]->normal;
+    const double* b = planes[(i + 2) % 3]->normal;
+    double c[3] = {
+      a[1] * b[2] - a[2] * b[1],
+      a[2] * b[0] - a[0] * b[2],
+      a[0] * b[1] - a[1] * b[0] };
+    for (uint32_t k = 0; k < 3; ++k)
+      point[k] += planes[i]->distance * c[k];
+    if (i == 0)
+      for (uint32_t k = 0; k < 3; ++k)
+        det += plane0.normal[k] * c[k];
+  }
+
+  assert(det != 0.0);
+  return { (float)(point[0] / det), (float)(point[1] / det),
+    (float)(point[2] / det) };
+}
+
+}
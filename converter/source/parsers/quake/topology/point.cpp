@@ -8,10 +8,15 @@
  * @copyright Copyright (c) 2025
  * 
  */
-#include <cstring>
 #include <converter/parsers/quake/topology/point.h>
 #include <converter/parsers/quake/topology/texture_data.h>
 
+#if defined(__SSE__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TOPOLOGY_SSE
+#include <xmmintrin.h>
+#endif
+
 
 namespace topology {
 
@@ -50,14 +55,14 @@ get_texture_axis_from_plane(
   yv = base_axis[best_axis * 3 + 2];
 }
 
-static
-void
-get_face_texture_vectors(
+texture_projection_t
+get_texture_projection(
   const texture_data_t& texture_data,
   const texture_info_t& texture_info,
-  const vector3f& normal,
-  float STfromXYZ[2][4])
+  const vector3f& normal)
 {
+  texture_projection_t projection;
+  float (*STfromXYZ)[4] = projection.st;
 	vector3f pvecs[2];
 	int32_t sv, tv;
 	float ang, sinv, cosv;
@@ -65,8 +70,6 @@ get_face_texture_vectors(
 	int32_t i, j;
   texture_data_t td = texture_data;
 
-	memset(STfromXYZ, 0, 8 * sizeof(float));
-
   td.scale[0] = td.scale[0] == 0 ? 1.f : td.scale[0];
   td.scale[1] = td.scale[1] == 0 ? 1.f : td.scale[1];
 
@@ -126,30 +129,87 @@ get_face_texture_vectors(
 		STfromXYZ[0][j] /= (float)texture_info.width;
 		STfromXYZ[1][j] /= (float)texture_info.height;
 	}
-}
 
-point3f
-get_texture_coordinates(
-  const point3f& point, 
-  const texture_data_t& texture_data,
-  const texture_info_t& texture_info,
-  const vector3f& normal)
-{
-  float STfromXYZ[2][4];
-	get_face_texture_vectors(texture_data, texture_info, normal, STfromXYZ);
-
-  point3f p[2] = {
-    { STfromXYZ[0][0], STfromXYZ[0][1], STfromXYZ[0][2] },
-    { STfromXYZ[1][0], STfromXYZ[1][1], STfromXYZ[1][2] }};
-	
-  point3f uvw = { 0, 0, 0 };
-	uvw.data[0] = dot_product_v3f(&point, p + 0) + STfromXYZ[0][3];
-	uvw.data[1] = dot_product_v3f(&point, p + 1) + STfromXYZ[1][3];
 	// NOTE: we flip since we are dealing with pngs.
-	uvw.data[1] *= -1.f;
+	for (j = 0; j < 4; ++j)
+		STfromXYZ[1][j] *= -1.f;
 
-  return uvw;
+  return projection;
 }
 ////////////////////////////////////////////////////////////////////////////////
 
+void
+get_texture_coordinates(
+  const texture_projection_t& projection,
+  const point3f* points,
+  uint32_t count,
+  point3f* uvs)
+{
+  const float (*st)[4] = projection.st;
+  uint32_t i = 0;
+
+#if defined(TOPOLOGY_SSE)
+  static_assert(
+    sizeof(point3f) == 3 * sizeof(float), "points are read as packed floats");
+
+  // 4 points at a time, their 12 floats are transposed into x, y and z lanes
+  // and the uvs are interleaved back the same way.
+  const __m128 s0 = _mm_set1_ps(st[0][0]), s1 = _mm_set1_ps(st[0][1]);
+  const __m128 s2 = _mm_set1_ps(st[0][2]), s3 = _mm_set1_ps(st[0][3]);
+  const __m128 t0 = _mm_set1_ps(st[1][0]), t1 = _mm_set1_ps(st[1][1]);
+  const __m128 t2 = _mm_set1_ps(st[1][2]), t3 = _mm_set1_ps(st[1][3]);
+  const __m128 zero = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4) {
+    const float* in = points[i].data;
+    __m128 a = _mm_loadu_ps(in + 0);    // x0 y0 z0 x1
+    __m128 b = _mm_loadu_ps(in + 4);    // y1 z1 x2 y2
+    __m128 c = _mm_loadu_ps(in + 8);    // z2 x3 y3 z3
+
+    __m128 x2y2x3y3 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+    __m128 y0z0y1z1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+    __m128 x = _mm_shuffle_ps(a, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0));
+    __m128 y = _mm_shuffle_ps(y0z0y1z1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0));
+    __m128 z = _mm_shuffle_ps(y0z0y1z1, c, _MM_SHUFFLE(3, 0, 3, 1));
+
+    __m128 u = _mm_add_ps(
+      _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(x, s0), _mm_mul_ps(y, s1)), _mm_mul_ps(z, s2)),
+      s3);
+    __m128 v = _mm_add_ps(
+      _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(x, t0), _mm_mul_ps(y, t1)), _mm_mul_ps(z, t2)),
+      t3);
+
+    __m128 u0v0u1v1 = _mm_unpacklo_ps(u, v);
+    __m128 u2v2u3v3 = _mm_unpackhi_ps(u, v);
+    __m128 u1v1zz = _mm_shuffle_ps(u0v0u1v1, zero, _MM_SHUFFLE(0, 0, 3, 2));
+    __m128 u3v3zz = _mm_shuffle_ps(u2v2u3v3, zero, _MM_SHUFFLE(0, 0, 3, 2));
+    __m128 zzu3v3 = _mm_movelh_ps(zero, u3v3zz);
+    float* out = uvs[i].data;
+    // u0 v0 0 u1 | v1 0 u2 v2 | 0 u3 v3 0
+    _mm_storeu_ps(
+      out + 0,
+      _mm_shuffle_ps(
+        _mm_movelh_ps(u0v0u1v1, zero), u1v1zz, _MM_SHUFFLE(0, 2, 1, 0)));
+    _mm_storeu_ps(
+      out + 4,
+      _mm_shuffle_ps(u1v1zz, u2v2u3v3, _MM_SHUFFLE(1, 0, 2, 1)));
+    _mm_storeu_ps(
+      out + 8,
+      _mm_shuffle_ps(zzu3v3, u3v3zz, _MM_SHUFFLE(2, 1, 2, 0)));
+  }
+#endif
+
+  for (; i < count; ++i) {
+    const float* point = points[i].data;
+    uvs[i].data[0] =
+      point[0] * st[0][0] + point[1] * st[0][1] + point[2] * st[0][2] +
+      st[0][3];
+    uvs[i].data[1] =
+      point[0] * st[1][0] + point[1] * st[1][1] + point[2] * st[1][2] +
+      st[1][3];
+    uvs[i].data[2] = 0.f;
+  }
+}
+
 }
\ No newline at end of file
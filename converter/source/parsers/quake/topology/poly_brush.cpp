@@ -9,31 +9,140 @@
  * 
  */
 #include <algorithm>
-#include <iterator>
-#include <converter/parsers/quake/topology/aabb.h>
+#include <atomic>
+#include <cmath>
 #include <converter/parsers/quake/topology/poly_brush.h>
+#include <converter/thread_pool.h>
 
 
 namespace topology {
 
-poly_brush_t::poly_brush_t(const brush_t* brush, const float radius)
-  : polygons{brush->to_polygons()}
+// running centroids bucketed by the grid cell they are in. A cell is twice the
+// weld radius, so every centroid within the radius of a point is in one of the
+// 8 cells around it.
+class weld_grid_t {
+public:
+  void
+  reset(const float radius, uint32_t capacity)
+  {
+    scale = 1.f / (2.f * radius);
+    uint32_t size = 16;
+    while (size < capacity * 2)
+      size <<= 1;
+    heads.assign(size, s_none);
+    next.clear();
+    cells.clear();
+  }
+
+  // buckets 'centroid' as the next index.
+  void
+  insert(const point3f& centroid)
+  {
+    cell_t cell = cell_of(centroid, 0.f);
+    uint32_t index = cells.size();
+    uint32_t bucket = bucket_of(cell);
+    cells.push_back(cell);
+    next.push_back(heads[bucket]);
+    heads[bucket] = index;
+  }
+
+  // moves 'index' to its new bucket if the centroid left its cell.
+  void
+  update(uint32_t index, const point3f& centroid)
+  {
+    cell_t cell = cell_of(centroid, 0.f);
+    if (same_cell(cell, cells[index]))
+      return;
+
+    uint32_t* link = &heads[bucket_of(cells[index])];
+    while (*link != index)
+      link = &next[*link];
+    *link = next[index];
+
+    uint32_t bucket = bucket_of(cell);
+    cells[index] = cell;
+    next[index] = heads[bucket];
+    heads[bucket] = index;
+  }
+
+  // the first centroid within 'radius' of 'point', -1 if there is none.
+  int32_t
+  find(
+    const point3f& point,
+    const std::vector<point3f>& centroids,
+    const float r2) const
+  {
+    cell_t base = cell_of(point, 0.5f);
+    uint32_t found = s_none;
+    for (int32_t x = 0; x < 2; ++x)
+      for (int32_t y = 0; y < 2; ++y)
+        for (int32_t z = 0; z < 2; ++z) {
+          cell_t cell = { base.x + x, base.y + y, base.z + z };
+          uint32_t index = heads[bucket_of(cell)];
+          for (; index != s_none; index = next[index])
+            if (
+              index < found &&
+              distance_points_squared(point, centroids[index]) <= r2)
+              found = index;
+        }
+
+    return found == s_none ? -1 : (int32_t)found;
+  }
+
+private:
+  static constexpr uint32_t s_none = UINT32_MAX;
+
+  struct cell_t {
+    int32_t x, y, z;
+  };
+
+  cell_t
+  cell_of(const point3f& point, const float shift) const
+  {
+    return {
+      (int32_t)floorf(point.data[0] * scale - shift),
+      (int32_t)floorf(point.data[1] * scale - shift),
+      (int32_t)floorf(point.data[2] * scale - shift) };
+  }
+
+  static
+  bool
+  same_cell(const cell_t& a, const cell_t& b)
+  {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+  }
+
+  uint32_t
+  bucket_of(const cell_t& cell) const
+  {
+    return hash_cell(cell.x, cell.y, cell.z) & (heads.size() - 1);
+  }
+
+  float scale = 1.f;
+  std::vector<uint32_t> heads;
+  // per centroid, the next one in its bucket and its cell.
+  std::vector<uint32_t> next;
+  std::vector<cell_t> cells;
+};
+
+// the brushes are converted in parallel, each thread keeps its grid.
+static thread_local weld_grid_t tl_weld_grid;
+
+poly_brush_t::poly_brush_t(
+  const brush_t* brush,
+  const polygon_engine_t engine,
+  const float radius)
+  : polygons{brush->to_polygons(engine, &open_face_count)}
 {
   const float r2 = radius * radius;
   std::vector<uint32_t> hits;
 
-  auto is_at = [this, r2, &hits](const point3f& position) -> int32_t {
-    for (uint32_t i = 0, count = meta.positions.size(); i < count; ++i) {
-      point3f target = meta.positions[i];
-      mult_set_v3f(&target, 1.f/(float)hits[i]);
-
-      float length = distance_points_squared(position, target);
-      if (length <= r2)
-        return (int32_t)i;
-    }
+  uint32_t point_count = 0;
+  for (auto& polygon : polygons)
+    point_count += polygon.points.size();
 
-    return -1;
-  };
+  weld_grid_t& grid = tl_weld_grid;
+  grid.reset(radius, point_count);
 
   for (auto& polygon : polygons) {
     // create the indexing structure per polygon
@@ -41,26 +150,25 @@ poly_brush_t::poly_brush_t(const brush_t* brush, const float radius)
     indexed_poly_t& indexed_poly = meta.polygons.back();
 
     for (auto& vertex : polygon.points) {
-      int32_t index = is_at(vertex);
+      int32_t index = grid.find(vertex, meta.positions, r2);
 
       if (index == -1) {
         indexed_poly.indices.push_back(meta.positions.size());
         meta.positions.push_back(vertex);
         hits.push_back(1);
+        grid.insert(vertex);
       } else {
+        // the centroid is kept normalized, it moves 1/n of the way.
         indexed_poly.indices.push_back((uint32_t)index);
-        add_set_v3f(&meta.positions[index], &vertex);
-        hits[index]++;
+        point3f& centroid = meta.positions[index];
+        vector3f delta = diff_v3f(&vertex, &centroid);
+        mult_set_v3f(&delta, 1.f/(float)++hits[index]);
+        add_set_v3f(&centroid, &delta);
+        grid.update((uint32_t)index, centroid);
       }
     }   
   }
 
-  // normalize meta.positions
-  for (uint32_t i = 0, count = meta.positions.size(); i < count; ++i) {
-    point3f& target = meta.positions[i];
-    mult_set_v3f(&target, 1.f/(float)hits[i]);
-  }
-
   // update the polygons vertices with the averaged positions
   for (uint32_t i = 0, count = meta.polygons.size(); i < count; ++i) {
     indexed_poly_t& indexed_poly = meta.polygons[i];
@@ -82,161 +190,238 @@ poly_brush_t::to_faces() const
   return faces;
 }
 
+// runs 'fn' over [0, count) in blocks, spread over the pool when there is one.
+// 'name' traces the blocks run on the pool.
+static
 void
-poly_brush_t::weld(
-  std::vector<poly_brush_t*>& brushes,
-  const float radius)
+for_blocks(
+  thread_pool_t* pool,
+  const char* name,
+  uint32_t count,
+  const std::function<void(uint32_t, uint32_t)>& fn)
 {
-  const float r2 = radius * radius;
-  using vertex_indices_t = std::vector<uint32_t>;
-
-  std::vector<vertex_indices_t> brushes_meta;
-  std::vector<point3f> positions;
-  std::vector<uint32_t> hits;
-
-  auto is_at = [r2, &hits, &positions](const point3f& position) -> int32_t {
-    for (uint32_t i = 0, count = positions.size(); i < count; ++i) {
-      point3f target = positions[i];
-      mult_set_v3f(&target, 1.f/(float)hits[i]);
-
-      float length = distance_points_squared(position, target);
-      if (length <= r2)
-        return (int32_t)i;
-    }
-
-    return -1;
+  const uint32_t block = 1024;
+  uint32_t blocks = (count + block - 1) / block;
+  auto run = [&](uint32_t i) {
+    fn(i * block, std::min(count, (i + 1) * block));
   };
 
-  for (poly_brush_t* brush : brushes) {
-    brushes_meta.emplace_back();
-    // maps the current brush meta positions to the intra-brushes shared ones
-    vertex_indices_t& to_index = brushes_meta.back();
+  if (pool)
+    pool->parallel_for(name, blocks, run);
+  else
+    for (uint32_t i = 0; i < blocks; ++i)
+      run(i);
+}
 
-    for (point3f& vertex : brush->meta.positions) {
-      int32_t index = is_at(vertex);
-      if (index == -1) {
-        to_index.push_back(positions.size());
-        positions.push_back(vertex);
-        hits.push_back(1);
-      } else {
-        to_index.push_back((uint32_t)index);
-        add_set_v3f(&positions[index], &vertex);
-        hits[index]++;
-      }
-    }
-  }
+using atomic_indices_t = std::vector<std::atomic<uint32_t>>;
 
-  // normalize the positions
-  for (uint32_t i = 0, count = positions.size(); i < count; ++i) {
-    point3f& target = positions[i];
-    mult_set_v3f(&target, 1.f/(float)hits[i]);
+// a root is its own parent. Parents only ever point to a lower index, with
+// path halving on the way up.
+static
+uint32_t
+find_root(atomic_indices_t& parent, uint32_t index)
+{
+  for (;;) {
+    uint32_t up = parent[index].load();
+    if (up == index)
+      return index;
+
+    uint32_t grand = parent[up].load();
+    if (grand != up)
+      parent[index].compare_exchange_weak(up, grand);
+    index = grand;
   }
+}
 
-  // copy back the positions into the brushes meta data and their polygons
-  for (uint32_t i = 0, count = brushes.size(); i < count; ++i) {
-    poly_brush_t* brush = brushes[i];
-    vertex_indices_t& to_index = brushes_meta[i];
-
-    // copy back into meta.positions of the current brush
-    for (uint32_t j = 0; j < brush->meta.positions.size(); ++j)
-      brush->meta.positions[j] = positions[to_index[j]];
-
-    // update the orginal polygons
-    for (uint32_t j = 0; j < brush->meta.polygons.size(); ++j) {
-      indexed_poly_t& indexed_poly = brush->meta.polygons[j];
-      polygon_t& polygon = brush->polygons[j];
-      
-      for (uint32_t k = 0; k < indexed_poly.indices.size(); ++k)
-        polygon.points[k] = brush->meta.positions[indexed_poly.indices[k]];
-    }
+// the higher root is linked under the lower one, so a set always ends up with
+// its lowest index as the root whatever order the unions ran in.
+static
+void
+unite(atomic_indices_t& parent, uint32_t a, uint32_t b)
+{
+  for (;;) {
+    a = find_root(parent, a);
+    b = find_root(parent, b);
+    if (a == b)
+      return;
+
+    if (a > b)
+      std::swap(a, b);
+    uint32_t expected = b;
+    if (parent[b].compare_exchange_strong(expected, a))
+      return;
   }
 }
 
 void
 poly_brush_t::sort_and_weld(
   std::vector<poly_brush_t>& brushes, 
+  thread_pool_t* pool,
   const float radius)
 {
+  static constexpr uint32_t s_none = UINT32_MAX;
   const float r2 = radius * radius;
 
-  struct node_t {
-    node_t(
-      const std::vector<point3f>& positions, 
-      uint32_t i)
-      : aabb{positions}
-      , brush_index{i}
-    {}
-
-    aabb_t aabb;
-    uint32_t brush_index;
-  };
+  // every brush position gets a map wide index, brush after brush.
+  const uint32_t brush_count = brushes.size();
+  std::vector<uint32_t> offsets(brush_count + 1, 0);
+  for (uint32_t i = 0; i < brush_count; ++i)
+    offsets[i + 1] = offsets[i] + brushes[i].meta.positions.size();
+
+  const uint32_t count = offsets.back();
+  if (!count)
+    return;
+
+  std::vector<point3f> positions(count);
+  for_blocks(pool, "weld_load", brush_count, [&](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i)
+      std::copy(
+        brushes[i].meta.positions.begin(),
+        brushes[i].meta.positions.end(),
+        positions.begin() + offsets[i]);
+  });
+
+  // 1. bucket every position in a grid of twice the radius, the buckets are
+  // pushed to without locks.
+  const float scale = 1.f / (2.f * radius);
+  uint32_t size = 16;
+  while (size < count * 2)
+    size <<= 1;
+  const uint32_t mask = size - 1;
+
+  atomic_indices_t heads(size);
+  std::vector<uint32_t> next(count);
+  for_blocks(pool, "weld_clear_grid", size, [&](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i)
+      heads[i].store(s_none, std::memory_order_relaxed);
+  });
+
+  for_blocks(pool, "weld_bucket", count, [&](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      const point3f& point = positions[i];
+      std::atomic<uint32_t>& head = heads[hash_cell(
+        (int32_t)floorf(point.data[0] * scale),
+        (int32_t)floorf(point.data[1] * scale),
+        (int32_t)floorf(point.data[2] * scale)) & mask];
+      uint32_t first = head.load(std::memory_order_relaxed);
+      do
+        next[i] = first;
+      while (!head.compare_exchange_weak(first, i));
+    }
+  });
+
+  // 2. join every position with the lower indexed ones within the radius, they
+  // are all in the 8 cells around it.
+  atomic_indices_t parent(count);
+  for_blocks(pool, "weld_init_sets", count, [&](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i)
+      parent[i].store(i, std::memory_order_relaxed);
+  });
+
+  for_blocks(pool, "weld_join", count, [&](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      const point3f& point = positions[i];
+      int32_t base[3];
+      for (uint32_t axis = 0; axis < 3; ++axis)
+        base[axis] = (int32_t)floorf(point.data[axis] * scale - 0.5f);
+
+      for (int32_t x = 0; x < 2; ++x)
+        for (int32_t y = 0; y < 2; ++y)
+          for (int32_t z = 0; z < 2; ++z) {
+            uint32_t bucket =
+              hash_cell(base[0] + x, base[1] + y, base[2] + z) & mask;
+            uint32_t other = heads[bucket].load(std::memory_order_relaxed);
+            for (; other != s_none; other = next[other])
+              if (
+                other < i &&
+                distance_points_squared(point, positions[other]) <= r2)
+                unite(parent, other, i);
+          }
+    }
+  });
+
+  // 3. the members of every group are listed in index order, so the clusters
+  // and their sums come out the same on every run.
+  std::vector<uint32_t> roots(count);
+  for_blocks(pool, "weld_roots", count, [&](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i)
+      roots[i] = find_root(parent, i);
+  });
+
+  std::vector<uint32_t> starts(count + 1, 0);
+  for (uint32_t i = 0; i < count; ++i)
+    ++starts[roots[i] + 1];
+  for (uint32_t i = 0; i < count; ++i)
+    starts[i + 1] += starts[i];
+
+  std::vector<uint32_t> members(count);
+  {
+    std::vector<uint32_t> cursors(starts.begin(), starts.end() - 1);
+    for (uint32_t i = 0; i < count; ++i)
+      members[cursors[roots[i]]++] = i;
+  }
 
-  std::vector<node_t> nodes;
-  for (uint32_t i = 0, count = brushes.size(); i < count; ++i)
-    nodes.emplace_back(brushes[i].meta.positions, i);
+  // 4. a chain of points each within the radius of the next would otherwise
+  // collapse however far apart its ends are. Within a group every point joins
+  // the first earlier seed within the radius, or seeds a cluster of its own,
+  // so no point moves further than the radius from its seed. The clusters are
+  // averaged relative to their seed.
+  std::vector<uint32_t> seeds(count);
+  std::vector<point3f> centroids(count);
+  for_blocks(pool, "weld_cluster", count, [&](uint32_t begin, uint32_t end) {
+    small_vector_t<uint32_t, 16> group_seeds;
+    small_vector_t<uint32_t, 16> sizes;
+    for (uint32_t root = begin; root < end; ++root) {
+      if (roots[root] != root)
+        continue;
+
+      group_seeds.clear();
+      sizes.clear();
+      for (uint32_t j = starts[root]; j < starts[root + 1]; ++j) {
+        uint32_t member = members[j];
+        const point3f& point = positions[member];
+        uint32_t k = 0;
+        for (; k < group_seeds.size(); ++k)
+          if (
+            distance_points_squared(point, positions[group_seeds[k]]) <= r2)
+            break;
+
+        if (k == group_seeds.size()) {
+          group_seeds.push_back(member);
+          sizes.push_back(0);
+          centroids[member] = { 0.f, 0.f, 0.f };
+        }
+
+        uint32_t seed = group_seeds[k];
+        seeds[member] = seed;
+        ++sizes[k];
+        vector3f delta = diff_v3f(&point, &positions[seed]);
+        add_set_v3f(&centroids[seed], &delta);
+      }
 
-  auto sweep = [](
-    const float min,
-    const float max, 
-    uint32_t axis,
-    std::vector<node_t> nodes) -> std::vector<node_t>
-  {
-    std::vector<float>::iterator iter_min, iter_max;
-    ptrdiff_t start, end;
-
-    std::sort(nodes.begin(), nodes.end(), 
-      [axis](const node_t& a, const node_t& b) { 
-        return a.aabb.min.data[axis] < b.aabb.min.data[axis]; 
-      });
-    std::vector<float> values;
-    std::transform(nodes.begin(), nodes.end(), std::back_inserter(values),
-      [axis](node_t& node) { return node.aabb.min.data[axis]; });
-
-    // first element that satisfies >=
-    iter_min = std::lower_bound(values.begin(), values.end(), min);
-    start = std::distance(values.begin(), iter_min);
-    // first element that satisfies > 
-    iter_max = std::upper_bound(values.begin(), values.end(), max);
-    end = std::distance(values.begin(), iter_max);
-
-    while (start > 0) {
-      if (nodes[start - 1].aabb.max.data[axis] >= min)
-        start--;
-      else
-        break;
+      for (uint32_t k = 0; k < group_seeds.size(); ++k) {
+        uint32_t seed = group_seeds[k];
+        mult_set_v3f(&centroids[seed], 1.f/(float)sizes[k]);
+        add_set_v3f(&centroids[seed], &positions[seed]);
+      }
     }
+  });
 
-    return std::vector<node_t>(nodes.begin() + start, nodes.begin() + end);
-  };
-
-  auto sweep_and_prune = 
-    [&](
-      const node_t& node,
-      float threshold = 1.f) -> std::vector<node_t>
-    {
-      std::vector<node_t> filtered = nodes;
-      for (uint32_t axis = 0; axis < 3; ++axis) {
-        filtered = sweep(
-        node.aabb.min.data[axis] - threshold, 
-        node.aabb.max.data[axis] + threshold, 
-        axis, 
-        filtered);
+  // copy back the positions into the brushes meta data and their polygons
+  for_blocks(pool, "weld_save", brush_count, [&](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      poly_brush_t& brush = brushes[i];
+      for (uint32_t j = 0; j < brush.meta.positions.size(); ++j)
+        brush.meta.positions[j] = centroids[seeds[offsets[i] + j]];
+
+      for (uint32_t j = 0; j < brush.meta.polygons.size(); ++j) {
+        indexed_poly_t& indexed_poly = brush.meta.polygons[j];
+        polygon_t& polygon = brush.polygons[j];
+        for (uint32_t k = 0; k < indexed_poly.indices.size(); ++k)
+          polygon.points[k] = brush.meta.positions[indexed_poly.indices[k]];
       }
-      
-      return filtered;
-    };
-
-  for (auto& node : nodes) {
-    std::vector<node_t> batch = sweep_and_prune(node);
-    // weld
-    std::vector<poly_brush_t*> brush_batch;
-    std::transform(batch.cbegin(), batch.cend(), std::back_inserter(brush_batch), 
-      [&](const node_t& node) {
-        return &brushes[node.brush_index];
-      });
-
-    weld(brush_batch);
-  }
+    }
+  });
 }
 
 }
\ No newline at end of file
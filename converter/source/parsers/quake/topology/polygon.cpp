@@ -9,100 +9,296 @@
  * 
  */
 #include <algorithm>
-#include <unordered_map>
+#include <cfloat>
+#include <cmath>
 #include <converter/parsers/quake/topology/polygon.h>
 #include <converter/parsers/quake/topology/point.h>
 
 
 namespace topology {
 
-polygon_t::clip_data_t
-polygon_t::clip(const plane_t& plane) const
+// the split parts keep everything but the points of the poly they came from.
+static
+void
+begin_part(const polygon_t& source, polygon_t* part, bool exact)
 {
-  clip_data_t data;
+  if (!part)
+    return;
 
-  std::vector<point_halfspace_classification_t> pt_classify;
+  part->points.clear();
+  part->normal = source.normal;
+  part->texture = source.texture;
+  part->texture_data = source.texture_data;
+  part->texture_info = source.texture_info;
+  part->projection = source.projection;
+  part->exact_plane = exact ? source.exact_plane : nullptr;
+  part->exact_edges.clear();
+}
+
+// 'edge_plane' is the plane of the edge out of 'point', kept for exact parts.
+static
+void
+add_point(
+  polygon_t* part,
+  const point3f& point,
+  const exact_plane_t* edge_plane)
+{
+  if (!part)
+    return;
+
+  part->points.push_back(point);
+  if (part->exact_plane)
+    part->exact_edges.push_back(edge_plane);
+}
+
+// the point is where the poly plane and the planes of the edges into and out
+// of it meet, its side of 'plane' is decided exactly. A point whose planes do
+// not meet at one point (collinear edges) falls back to the float test.
+static
+point_halfspace_classification_t
+classify_exact(
+  const polygon_t& polygon,
+  uint32_t index,
+  const plane_t& plane)
+{
+  uint32_t count = polygon.points.size();
+  const exact_plane_t& in = *polygon.exact_edges[(index + count - 1) % count];
+  const exact_plane_t& out = *polygon.exact_edges[index];
+  if (!orient_normals(*polygon.exact_plane, in, out))
+    return classify_point_halfspace(
+      &plane.face, &plane.normal, &polygon.points[index]);
+
+  int32_t side = orient_vertex(plane.exact, *polygon.exact_plane, in, out);
+  if (side > 0)
+    return POINT_IN_POSITIVE_HALFSPACE;
+  return side < 0 ? POINT_IN_NEGATIVE_HALFSPACE : POINT_ON_PLANE;
+}
+
+polygon_t::side_t
+polygon_t::clip(
+  const plane_t& plane,
+  polygon_t* front,
+  polygon_t* back,
+  edge_t& edge) const
+{
+  // .map brushes carry exact planes, a poly of the cutting cube and the faces
+  // cut from it know the planes their points come from.
+  const bool exact =
+    plane.exact.valid &&
+    exact_plane &&
+    exact_edges.size() == points.size();
+
+  small_vector_t<point_halfspace_classification_t, 16> pt_classify;
   int32_t on_positive = 0, on_negative = 0;
-  for (auto& point : points) {
-    auto classification = classify_point_halfspace(
-      &plane.face, &plane.normal, &point);
+  for (uint32_t i = 0, count = points.size(); i < count; ++i) {
+    auto classification = exact ?
+      classify_exact(*this, i, plane) :
+      classify_point_halfspace(&plane.face, &plane.normal, &points[i]);
     pt_classify.push_back(classification);
     on_positive += classification == POINT_IN_POSITIVE_HALFSPACE;
     on_negative += classification == POINT_IN_NEGATIVE_HALFSPACE; 
   }
 
   // to the back or colinear with the plane add to the back
-  if (on_positive == 0 || (on_positive == 0 && on_negative == 0))
-    data.back = std::make_shared<polygon_t>(*this);
+  if (on_positive == 0)
+    return side_t::back;
   else if (on_negative == 0)
-    data.front = std::make_shared<polygon_t>(*this);
-  else {
-    data.front = std::make_shared<polygon_t>(*this);
-    data.front->points.clear();
-    data.back = std::make_shared<polygon_t>(*this);
-    data.back->points.clear();
-    data.edge = std::make_shared<edge_t>();
-    uint32_t edge_index = 0;
-
-    auto&& classify_add = [&](uint32_t index) {
-      if (pt_classify[index] == POINT_IN_POSITIVE_HALFSPACE)
-        data.front->points.push_back(points[index]);
-      else if (pt_classify[index] == POINT_IN_NEGATIVE_HALFSPACE)
-        data.back->points.push_back(points[index]);
-      else {
-        data.front->points.push_back(points[index]);
-        data.back->points.push_back(points[index]);
-        data.edge->points[edge_index++] = points[index];
-        assert(edge_index <= 2);
-      }
-    };
-
-    for (uint32_t i = 0, count = points.size(); i < count; ++i) {
-      uint32_t idx0 = i; 
-      uint32_t idx1 = (i + 1) % count; 
-      
-      // no splitting is required, simply classify add the starting point
-      if (
-        pt_classify[idx0] == pt_classify[idx1] || 
-        pt_classify[idx0] == POINT_ON_PLANE || 
-        pt_classify[idx1] == POINT_ON_PLANE)
-        classify_add(idx0);
+    return side_t::front;
+
+  begin_part(*this, front, exact);
+  begin_part(*this, back, exact);
+  uint32_t edge_index = 0;
+
+  // a part leaves a point along the same edge unless the next point is on the
+  // other side, it then runs along the cutting plane.
+  const exact_plane_t* cut = exact ? &plane.exact : nullptr;
+  auto&& edge_plane = [&](uint32_t index) {
+    return exact ? exact_edges[index] : nullptr;
+  };
+
+  auto&& classify_add = [&](uint32_t index) {
+    uint32_t next = (index + 1) % points.size();
+    if (pt_classify[index] == POINT_IN_POSITIVE_HALFSPACE)
+      add_point(front, points[index], edge_plane(index));
+    else if (pt_classify[index] == POINT_IN_NEGATIVE_HALFSPACE)
+      add_point(back, points[index], edge_plane(index));
+    else {
+      add_point(
+        front,
+        points[index],
+        pt_classify[next] == POINT_IN_NEGATIVE_HALFSPACE ?
+          cut : edge_plane(index));
+      add_point(
+        back,
+        points[index],
+        pt_classify[next] == POINT_IN_POSITIVE_HALFSPACE ?
+          cut : edge_plane(index));
+      edge.points[edge_index++] = points[index];
+      assert(edge_index <= 2);
+    }
+  };
+
+  for (uint32_t i = 0, count = points.size(); i < count; ++i) {
+    uint32_t idx0 = i; 
+    uint32_t idx1 = (i + 1) % count; 
+    
+    // no splitting is required, simply classify add the starting point
+    if (
+      pt_classify[idx0] == pt_classify[idx1] || 
+      pt_classify[idx0] == POINT_ON_PLANE || 
+      pt_classify[idx1] == POINT_ON_PLANE)
+      classify_add(idx0);
+    else {
+      // intersection calculation is required here. The exact planes meet at
+      // one point, the edge crosses the plane.
+      point3f intersection;
+      if (exact)
+        intersection = intersect_exact_planes(
+          *exact_plane, *exact_edges[idx0], plane.exact);
       else {
-        // intersection calculation is required here.
         segment_t segment;
         segment.points[0] = points[idx0];
         segment.points[1] = points[idx1];
 
-        point3f intersection;
         float t = 0.f;
-        segment_plane_classification_t result = classify_segment_face(
+        classify_segment_face(
           &plane.face, &plane.normal, &segment, &intersection, &t);
-
-        if (pt_classify[idx0] == POINT_IN_POSITIVE_HALFSPACE)
-          data.front->points.push_back(points[idx0]);
-        else
-          data.back->points.push_back(points[idx0]);
-        data.front->points.push_back(intersection);
-        data.back->points.push_back(intersection);
-        data.edge->points[edge_index++] = intersection;
-        assert(edge_index <= 2);
       }
+
+      bool leaves_front = pt_classify[idx0] == POINT_IN_POSITIVE_HALFSPACE;
+      if (leaves_front)
+        add_point(front, points[idx0], edge_plane(idx0));
+      else
+        add_point(back, points[idx0], edge_plane(idx0));
+      add_point(front, intersection, leaves_front ? cut : edge_plane(idx0));
+      add_point(back, intersection, leaves_front ? edge_plane(idx0) : cut);
+      edge.points[edge_index++] = intersection;
+      assert(edge_index <= 2);
+    }
+  }
+
+  return side_t::split;
+}
+
+// the triangle 'i0, i1, i2' of 'points', with the matching 'uvs'.
+static
+face_t
+textured_face(
+  const polygon_t& polygon,
+  const point3f* points,
+  const point3f* uvs,
+  uint32_t i0,
+  uint32_t i1,
+  uint32_t i2)
+{
+  return {
+    { points[i0], points[i1], points[i2] },
+    polygon.normal,
+    polygon.texture,
+    polygon.texture_data,
+    polygon.texture_info,
+    { uvs[i0], uvs[i1], uvs[i2] }};
+}
+
+// every corner turns the same way as the normal, no 3 points in a row.
+static
+bool
+is_convex(const polygon_t& polygon)
+{
+  const auto& points = polygon.points;
+  for (uint32_t i = 0, count = points.size(); i < count; ++i) {
+    const point3f& before = points[(i + count - 1) % count];
+    const point3f& after = points[(i + 1) % count];
+    vector3f edge0 = diff_v3f(&points[i], &before);
+    vector3f edge1 = diff_v3f(&after, &points[i]);
+    vector3f turn = cross_product_v3f(&edge0, &edge1);
+    if (dot_product_v3f(&turn, &polygon.normal) <= 0.f)
+      return false;
+  }
+
+  return true;
+}
+
+// cos(angle) * |cos(angle)| at 'at', it orders the angles like the cosine does
+// (largest for the smallest angle) without the square roots.
+static
+float
+corner_cosine(const point3f& at, const point3f& p1, const point3f& p2)
+{
+  vector3f vec0 = diff_v3f(&p1, &at);
+  vector3f vec1 = diff_v3f(&p2, &at);
+  float dot = dot_product_v3f(&vec0, &vec1);
+  float lengths = length_squared_v3f(&vec0) * length_squared_v3f(&vec1);
+  return dot * fabs(dot) / lengths;
+}
+
+// the fan apex whose triangles have the largest minimum angle, the first one
+// wins a tie.
+static
+uint32_t
+best_fan_apex(const polygon_t& polygon)
+{
+  const auto& points = polygon.points;
+  uint32_t count = points.size();
+  uint32_t best_apex = 0;
+  float best_cosine = FLT_MAX;
+  for (uint32_t apex = 0; apex < count; ++apex) {
+    float worst_cosine = -FLT_MAX;
+    for (uint32_t k = 1; k + 1 < count && worst_cosine < best_cosine; ++k) {
+      const point3f& a = points[apex];
+      const point3f& b = points[(apex + k) % count];
+      const point3f& c = points[(apex + k + 1) % count];
+      worst_cosine = std::max(worst_cosine, corner_cosine(a, b, c));
+      worst_cosine = std::max(worst_cosine, corner_cosine(b, c, a));
+      worst_cosine = std::max(worst_cosine, corner_cosine(c, a, b));
+    }
+
+    if (worst_cosine < best_cosine) {
+      best_cosine = worst_cosine;
+      best_apex = apex;
     }
   }
 
-  return data;
+  return best_apex;
 }
 
 std::vector<face_t>
 polygon_t::triangulate() const
 {
   std::vector<face_t> tris;
+  // a degenerate polygon has nothing to triangulate.
+  if (points.size() < 3)
+    return tris;
+  tris.reserve(points.size() - 2);
+
+  // every point is shared by several triangles, project them all at once.
+  small_vector_t<point3f, 16> uvs;
+  uvs.resize(points.size());
+  get_texture_coordinates(projection, points.data(), points.size(), uvs.data());
+
+  // brush faces are convex, fan them out of the best apex.
+  if (is_convex(*this)) {
+    uint32_t count = points.size();
+    uint32_t apex = best_fan_apex(*this);
+    for (uint32_t k = 1; k + 1 < count; ++k)
+      tris.push_back(textured_face(
+        *this,
+        points.data(),
+        uvs.data(),
+        apex,
+        (apex + k) % count,
+        (apex + k + 1) % count));
+    return tris;
+  }
+
+  // the uvs are clipped along with the points.
   polygon_t polygon = *this;
 
   // iterate to locate best candidate for ear clipping
   while (polygon.points.size() > 3) {
-    std::unordered_map<uint32_t, float> i_to_angle;
     uint32_t count = polygon.points.size();
+    uint32_t ear = count;
+    float ear_angle = -FLT_MAX;
     for (uint32_t i_at = 0; i_at < count; ++i_at) {
       uint32_t i_before = (i_at + count - 1) % count;
       uint32_t i_after = (i_at + 1) % count;
@@ -138,7 +334,7 @@ polygon_t::triangulate() const
           }
         }
 
-        // get the angle, we will need this.
+        // keep the ear with the largest angle.
         if (valid) {
           vector3f vec0, vec1;
           vector3f_set_diff_v3f(&vec0, tri.points + 0, tri.points + 1);
@@ -150,69 +346,30 @@ polygon_t::triangulate() const
             dot = K_PI - acosf(fabs(dot));
           else
             dot = acosf(dot);
-          i_to_angle[i_at] = TO_DEGREES(dot);
+          if (dot > ear_angle) {
+            ear_angle = dot;
+            ear = i_at;
+          }
         }
       }
     }
 
-    {
-      // clip the ear with the largest angle.
-      auto ear = std::max_element(
-        std::begin(i_to_angle), 
-        std::end(i_to_angle), 
-        [](
-          const std::pair<uint32_t, float>& p1, 
-          const std::pair<uint32_t, float>& p2) {
-          return p1.second < p2.second;});
-
-      uint32_t i_at = ear->first;
-      uint32_t i_before = (i_at + count - 1) % count;
-      uint32_t i_after = (i_at + 1) % count;
-
-      ::face_t tri = {
-        polygon.points[i_before], 
-        polygon.points[i_at], 
-        polygon.points[i_after]};
-
-      point3f uv[3];
-      uv[0] = get_texture_coordinates(
-        tri.points[0], polygon.texture_data, polygon.texture_info, normal);
-      uv[1] = get_texture_coordinates(
-        tri.points[1], polygon.texture_data, polygon.texture_info, normal);
-      uv[2] = get_texture_coordinates(
-        tri.points[2], polygon.texture_data, polygon.texture_info, normal);
-
-      tris.push_back({
-        tri,
-        normal,
-        polygon.texture,
-        polygon.texture_data,
-        polygon.texture_info, 
-        { uv[0], uv[1], uv[2] }});
-      polygon.points.erase(polygon.points.begin() + i_at);
-    }
+    assert(ear != count && "no ear left to clip");
+    uint32_t i_before = (ear + count - 1) % count;
+    uint32_t i_after = (ear + 1) % count;
+    tris.push_back(textured_face(
+      polygon,
+      polygon.points.data(),
+      uvs.data(),
+      i_before,
+      ear,
+      i_after));
+    polygon.points.erase(polygon.points.begin() + ear);
+    uvs.erase(uvs.begin() + ear);
   }
 
-  ::face_t tri = {
-    polygon.points[0],
-    polygon.points[1],
-    polygon.points[2] };
-  
-  point3f uv[3];
-  uv[0] = get_texture_coordinates(
-    tri.points[0], polygon.texture_data, polygon.texture_info, normal);
-  uv[1] = get_texture_coordinates(
-    tri.points[1], polygon.texture_data, polygon.texture_info, normal);
-  uv[2] = get_texture_coordinates(
-    tri.points[2], polygon.texture_data, polygon.texture_info, normal);
-  
-  tris.push_back({
-    tri,
-    normal,
-    polygon.texture,
-    polygon.texture_data,
-    polygon.texture_info,
-    { uv[0], uv[1], uv[2] }});
+  tris.push_back(textured_face(
+    polygon, polygon.points.data(), uvs.data(), 0, 1, 2));
 
   return tris;
 }
@@ -220,37 +377,58 @@ polygon_t::triangulate() const
 bool
 polygon_t::sanitize()
 {
+  // NOTE: both passes compact in place behind a write cursor. They keep the
+  // points the erase-as-you-go loops did, a dropped point is compared against
+  // the next one read and, for the last point, the first one kept. The exact
+  // edge planes go with their points, the edge out of the previous point takes
+  // over from the one dropped.
+  const bool exact = exact_plane && exact_edges.size() == points.size();
+
   // simplify the poly by removing duplicate subsequent vertices
-  for (uint32_t i = 0; i < points.size(); ) {
-    uint32_t count = points.size();
-    uint32_t i_at = i;
-    uint32_t i_next = (i + 1) % count;
-    point3f& p1 = points[i_at];
-    point3f& p2 = points[i_next];
-    if (identical_points(p1, p2))
-      points.erase(points.begin() + i);
-    else
-      ++i;
+  uint32_t count = points.size();
+  uint32_t kept = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    // the only point left is a duplicate of itself.
+    bool duplicate = i + 1 < count ?
+      identical_points(points[i], points[i + 1]) :
+      !kept || identical_points(points[i], points[0]);
+    if (!duplicate) {
+      if (exact)
+        exact_edges[kept] = exact_edges[i];
+      points[kept++] = points[i];
+    }
   }
+  points.resize(kept);
 
-  // simplify the polygon, by removing colinear lines
-  for (uint32_t i = 1; i < points.size(); ) {
-    uint32_t count = points.size();
-    uint32_t i_at = i;
-    uint32_t i_prev = (i + count - 1) % count;
-    uint32_t i_next = (i + 1) % count;
-    vector3f diff1, diff2;
-    vector3f_set_diff_v3f(&diff1, &points[i_prev], &points[i_at]);
-    normalize_set_v3f(&diff1);
-    vector3f_set_diff_v3f(&diff2, &points[i_at], &points[i_next]);
+  // simplify the polygon, by removing colinear lines. The direction into a
+  // kept point is the direction out of the previous one.
+  count = points.size();
+  kept = count ? 1 : 0;
+  vector3f diff1, diff2;
+  bool has_diff1 = false;
+  for (uint32_t i = 1; i < count; ++i) {
+    const point3f& next = i + 1 < count ? points[i + 1] : points[0];
+    if (!has_diff1) {
+      vector3f_set_diff_v3f(&diff1, &points[kept - 1], &points[i]);
+      normalize_set_v3f(&diff1);
+    }
+    vector3f_set_diff_v3f(&diff2, &points[i], &next);
     normalize_set_v3f(&diff2);
     float dot = dot_product_v3f(&diff1, &diff2);
     // we can remove the point.
     if (IS_SAME_LP(dot, 1.f))
-      points.erase(points.begin() + i);
-    else
-      ++i;
+      has_diff1 = false;
+    else {
+      if (exact)
+        exact_edges[kept] = exact_edges[i];
+      points[kept++] = points[i];
+      diff1 = diff2;
+      has_diff1 = true;
+    }
   }
+  points.resize(kept);
+  if (exact)
+    exact_edges.resize(kept);
 
   // this could happen if the edges making up the poly are colinear
   return points.size() >= 3;
@@ -0,0 +1,358 @@
+/**
+ * @file wad.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <converter/parsers/quake/deflate.h>
+#include <converter/parsers/quake/wad.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace wad {
+
+static constexpr uint8_t s_type_palette = 0x40;
+static constexpr uint8_t s_type_miptex = 0x44;
+
+// all fields are little endian in the file.
+static
+uint32_t
+read_u32(const uint8_t* data)
+{
+  return
+    (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+    ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static
+std::string
+read_name(const uint8_t* data)
+{
+  const char* name = (const char*)data;
+  return std::string(name, strnlen(name, 16));
+}
+
+wad_file_t::wad_file_t(const std::string& path)
+{
+#if defined(_WIN32)
+  HANDLE handle = CreateFileA(
+    path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL, NULL);
+  if (handle == INVALID_HANDLE_VALUE)
+    return;
+  file = handle;
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(handle, &file_size) || !file_size.QuadPart)
+    return;
+  mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!mapping)
+    return;
+  data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  size = data ? (size_t)file_size.QuadPart : 0;
+#else
+  int handle = open(path.c_str(), O_RDONLY);
+  if (handle < 0)
+    return;
+
+  // the mapping outlives the descriptor.
+  struct stat info;
+  if (fstat(handle, &info) == 0 && info.st_size > 0) {
+    void* view = mmap(
+      nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+    if (view != MAP_FAILED) {
+      data = (const uint8_t*)view;
+      size = (size_t)info.st_size;
+    }
+  }
+  close(handle);
+#endif
+
+  if (data)
+    parse();
+}
+
+wad_file_t::~wad_file_t()
+{
+#if defined(_WIN32)
+  if (data)
+    UnmapViewOfFile(data);
+  if (mapping)
+    CloseHandle(mapping);
+  if (file)
+    CloseHandle(file);
+#else
+  if (data)
+    munmap((void*)data, size);
+#endif
+}
+
+void
+wad_file_t::parse()
+{
+  if (size < 12 || memcmp(data, "WAD2", 4))
+    return;
+
+  // directory entry: filepos, disksize, size, type, compression, pad[2],
+  // name[16].
+  const uint32_t entry_size = 32;
+  uint32_t count = read_u32(data + 4);
+  uint32_t directory = read_u32(data + 8);
+  if (directory > size || count > (size - directory) / entry_size)
+    return;
+
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint8_t* entry = data + directory + i * entry_size;
+    uint32_t offset = read_u32(entry);
+    uint32_t length = read_u32(entry + 4);
+    uint8_t type = entry[12];
+    uint8_t compression = entry[13];
+    if (compression || offset > size || length > size - offset)
+      continue;
+
+    if (type == s_type_palette && length >= 768) {
+      palette = data + offset;
+    } else if (type == s_type_miptex && length >= 40) {
+      // miptex header: name[16], width, height, offsets[4].
+      const uint8_t* lump = data + offset;
+      miptex_t texture;
+      texture.name = read_name(entry + 16);
+      texture.width = read_u32(lump + 16);
+      texture.height = read_u32(lump + 20);
+      uint32_t pixels = read_u32(lump + 24);
+      uint64_t pixel_count = (uint64_t)texture.width * texture.height;
+      if (
+        !pixel_count ||
+        pixels > length ||
+        pixel_count > length - pixels) {
+        printf("skipping malformed miptex '%s'\n", texture.name.c_str());
+        continue;
+      }
+      texture.pixels = lump + pixels;
+      textures.push_back(texture);
+    }
+  }
+}
+
+bool
+wad_file_t::is_valid() const
+{
+  return data != nullptr && size >= 12 && !memcmp(data, "WAD2", 4);
+}
+
+const std::vector<miptex_t>&
+wad_file_t::get_textures() const
+{
+  return textures;
+}
+
+const uint8_t*
+wad_file_t::get_palette() const
+{
+  return palette;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// quake draws the last 32 palette entries at full brightness, '{' textures are
+// cut out, their index 255 is see-through.
+static constexpr uint8_t s_first_fullbright = 224;
+static constexpr uint8_t s_transparent_index = 255;
+
+static
+bool
+is_cutout(const miptex_t& texture)
+{
+  return texture.name.size() && texture.name[0] == '{';
+}
+
+bool
+has_fullbright_pixels(const miptex_t& texture)
+{
+  bool cutout = is_cutout(texture);
+  const uint8_t* pixels = texture.pixels;
+  size_t count = (size_t)texture.width * texture.height;
+  for (size_t i = 0; i < count; ++i)
+    if (
+      pixels[i] >= s_first_fullbright &&
+      !(cutout && pixels[i] == s_transparent_index))
+      return true;
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// minimal png writer, every scanline gets the filter with the smallest sum of
+// absolute residuals (the libpng heuristic) before the image is deflated.
+static
+uint32_t
+crc32(uint32_t crc, const uint8_t* data, size_t size)
+{
+  static const std::vector<uint32_t> s_table = []() {
+    std::vector<uint32_t> table(256);
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t value = i;
+      for (uint32_t k = 0; k < 8; ++k)
+        value = value & 1 ? 0xedb88320u ^ (value >> 1) : value >> 1;
+      table[i] = value;
+    }
+    return table;
+  }();
+
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i)
+    crc = s_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
+
+static
+uint8_t
+paeth(uint8_t left, uint8_t up, uint8_t up_left)
+{
+  int32_t estimate = (int32_t)left + up - up_left;
+  int32_t to_left = std::abs(estimate - left);
+  int32_t to_up = std::abs(estimate - up);
+  int32_t to_up_left = std::abs(estimate - up_left);
+  if (to_left <= to_up && to_left <= to_up_left)
+    return left;
+  return to_up <= to_up_left ? up : up_left;
+}
+
+// writes the filter type and the 'size' filtered bytes of 'line' to 'out'.
+// 'above' is the previous unfiltered scanline, zeros for the first one.
+// 'candidates' holds 5 * 'size' bytes, one filtered line per filter type.
+static
+void
+filter_scanline(
+  const uint8_t* line,
+  const uint8_t* above,
+  size_t size,
+  uint32_t channels,
+  uint8_t* candidates,
+  uint8_t* out)
+{
+  uint8_t best = 0;
+  uint64_t best_sum = UINT64_MAX;
+  for (uint8_t type = 0; type < 5; ++type) {
+    uint8_t* filtered = candidates + type * size;
+    uint64_t sum = 0;
+    for (size_t x = 0; x < size; ++x) {
+      uint8_t left = x >= channels ? line[x - channels] : 0;
+      uint8_t up_left = x >= channels ? above[x - channels] : 0;
+      uint8_t up = above[x];
+      uint8_t predicted = 0;
+      switch (type) {
+        case 1: predicted = left; break;
+        case 2: predicted = up; break;
+        case 3: predicted = (uint8_t)(((uint32_t)left + up) / 2); break;
+        case 4: predicted = paeth(left, up, up_left); break;
+      }
+      filtered[x] = (uint8_t)(line[x] - predicted);
+      sum += std::abs((int32_t)(int8_t)filtered[x]);
+    }
+    if (sum < best_sum) {
+      best_sum = sum;
+      best = type;
+    }
+  }
+
+  out[0] = best;
+  memcpy(out + 1, candidates + best * size, size);
+}
+
+static
+void
+put_u32_be(std::vector<uint8_t>& buffer, uint32_t value)
+{
+  buffer.push_back((uint8_t)(value >> 24));
+  buffer.push_back((uint8_t)(value >> 16));
+  buffer.push_back((uint8_t)(value >> 8));
+  buffer.push_back((uint8_t)value);
+}
+
+static
+void
+put_chunk(
+  std::vector<uint8_t>& png,
+  const char type[4],
+  const std::vector<uint8_t>& payload)
+{
+  put_u32_be(png, (uint32_t)payload.size());
+  size_t start = png.size();
+  png.insert(png.end(), type, type + 4);
+  png.insert(png.end(), payload.begin(), payload.end());
+  put_u32_be(png, crc32(0, png.data() + start, png.size() - start));
+}
+
+bool
+write_png(
+  const miptex_t& texture,
+  const uint8_t* palette,
+  const std::string& path)
+{
+  // rgba only for the cutouts, index 255 gets a zero alpha.
+  const bool cutout = is_cutout(texture);
+  const uint32_t channels = cutout ? 4 : 3;
+  const size_t row = (size_t)texture.width * channels;
+
+  std::vector<uint8_t> pixels(row * texture.height);
+  for (size_t i = 0, count = (size_t)texture.width * texture.height;
+    i < count; ++i) {
+    uint8_t index = texture.pixels[i];
+    uint8_t* pixel = pixels.data() + i * channels;
+    memcpy(pixel, palette + index * 3, 3);
+    if (cutout)
+      pixel[3] = index == s_transparent_index ? 0 : 255;
+  }
+
+  // every scanline starts with its filter type.
+  std::vector<uint8_t> raw((row + 1) * texture.height);
+  std::vector<uint8_t> zeros(row, 0);
+  std::vector<uint8_t> candidates(row * 5);
+  for (uint32_t y = 0; y < texture.height; ++y) {
+    const uint8_t* line = pixels.data() + y * row;
+    filter_scanline(
+      line,
+      y ? line - row : zeros.data(),
+      row,
+      channels,
+      candidates.data(),
+      raw.data() + y * (row + 1));
+  }
+
+  std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  {
+    std::vector<uint8_t> header;
+    put_u32_be(header, texture.width);
+    put_u32_be(header, texture.height);
+    // 8 bits per channel, rgb(a), deflate, adaptive filtering, no interlace.
+    header.insert(header.end(), { 8, (uint8_t)(cutout ? 6 : 2), 0, 0, 0 });
+    put_chunk(png, "IHDR", header);
+  }
+
+  put_chunk(png, "IDAT", deflate::zlib_compress(raw.data(), raw.size()));
+  put_chunk(png, "IEND", {});
+
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file)
+    return false;
+  bool success = fwrite(png.data(), 1, png.size(), file) == png.size();
+  return fclose(file) == 0 && success;
+}
+
+}
@@ -0,0 +1,215 @@
+/**
+ * @file thread_pool.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <converter/thread_pool.h>
+#include <converter/trace.h>
+
+
+// identifies the pool/queue owned by the calling thread, if any.
+static thread_local thread_pool_t* tl_pool = nullptr;
+static thread_local uint32_t tl_index = 0;
+
+thread_pool_t::thread_pool_t(uint32_t thread_count)
+{
+  if (thread_count == 0)
+    thread_count = std::thread::hardware_concurrency();
+  thread_count = thread_count ? thread_count : 1;
+
+  for (uint32_t i = 0; i < thread_count; ++i)
+    queues.push_back(std::make_unique<queue_t>());
+
+  for (uint32_t i = 0; i < thread_count; ++i)
+    threads.emplace_back([this, i]() { worker(i); });
+}
+
+thread_pool_t::~thread_pool_t()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+
+  wake.notify_all();
+  for (auto& thread : threads)
+    thread.join();
+}
+
+void
+thread_pool_t::submit(task_t task)
+{
+  uint32_t index;
+  if (tl_pool == this)
+    index = tl_index;
+  else
+    index = next_queue.fetch_add(1) % (uint32_t)queues.size();
+
+  pending.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lock(queues[index]->mutex);
+    queues[index]->tasks.push_back(std::move(task));
+  }
+
+  {
+    // taken under the mutex so a worker about to sleep cannot miss it.
+    std::lock_guard<std::mutex> lock(mutex);
+    queued.fetch_add(1);
+  }
+  wake.notify_one();
+}
+
+void
+thread_pool_t::wait()
+{
+  // the caller only blocks, running tasks here would put one more job in
+  // flight than the pool has threads.
+  std::unique_lock<std::mutex> lock(mutex);
+  idle.wait(lock, [this]() { return pending.load() == 0; });
+}
+
+void
+thread_pool_t::parallel_for(
+  const char* name,
+  uint32_t count,
+  const std::function<void(uint32_t)>& fn)
+{
+  // helpers can start after the call returned, they only touch 'fn' once they
+  // claimed an index, which cannot happen by then.
+  struct state_t {
+    const std::function<void(uint32_t)>* fn;
+    const char* name;
+    uint32_t count;
+    uint32_t grain;
+    std::atomic<uint32_t> next{0};
+    std::atomic<uint32_t> done{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+
+  if (count == 0)
+    return;
+
+  auto state = std::make_shared<state_t>();
+  state->fn = &fn;
+  state->name = name;
+  state->count = count;
+  // a few batches per thread keeps the claims cheap and the load balanced.
+  state->grain = std::max<uint32_t>(1, count / (size() * 8));
+
+  auto claim = [](state_t& state) {
+    while (true) {
+      uint32_t begin = state.next.fetch_add(state.grain);
+      if (begin >= state.count)
+        return;
+
+      uint32_t end = std::min(begin + state.grain, state.count);
+      {
+        trace::scope_t scope(
+          state.name,
+          trace::is_enabled() ?
+            std::to_string(begin) + ".." + std::to_string(end) :
+            std::string());
+        for (uint32_t i = begin; i < end; ++i)
+          (*state.fn)(i);
+      }
+
+      if (state.done.fetch_add(end - begin) + (end - begin) == state.count) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.finished.notify_all();
+      }
+    }
+  };
+
+  uint32_t batches = (count + state->grain - 1) / state->grain;
+  uint32_t helpers = std::min(size(), batches) - 1;
+  for (uint32_t i = 0; i < helpers; ++i)
+    submit([state, claim]() { claim(*state); });
+
+  claim(*state);
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->finished.wait(lock, [&]() { return state->done.load() == count; });
+}
+
+bool
+thread_pool_t::pop(uint32_t index, task_t& task)
+{
+  queue_t& queue = *queues[index];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty())
+    return false;
+
+  task = std::move(queue.tasks.front());
+  queue.tasks.pop_front();
+  queued.fetch_sub(1);
+  return true;
+}
+
+bool
+thread_pool_t::steal(uint32_t thief, task_t& task)
+{
+  const uint32_t count = (uint32_t)queues.size();
+  for (uint32_t i = 1; i <= count; ++i) {
+    uint32_t victim = (thief + i) % count;
+    if (victim == thief)
+      continue;
+
+    queue_t& queue = *queues[victim];
+    std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || queue.tasks.empty())
+      continue;
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queued.fetch_sub(1);
+    return true;
+  }
+
+  return false;
+}
+
+bool
+thread_pool_t::find_task(uint32_t index, task_t& task)
+{
+  return pop(index, task) || steal(index, task);
+}
+
+void
+thread_pool_t::run(task_t& task)
+{
+  task();
+
+  if (pending.fetch_sub(1) == 1) {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.notify_all();
+  }
+}
+
+void
+thread_pool_t::worker(uint32_t index)
+{
+  tl_pool = this;
+  tl_index = index;
+
+  while (true) {
+    task_t task;
+    if (find_task(index, task)) {
+      run(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.wait(lock, [this]() { return stop || queued.load() > 0; });
+    if (stop && queued.load() == 0)
+      return;
+  }
+}
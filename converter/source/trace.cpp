@@ -0,0 +1,176 @@
+/**
+ * @file trace.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <converter/trace.h>
+#include <converter/allocators/tracking.h>
+
+
+namespace trace {
+
+struct event_t {
+  const char* name;
+  std::string detail;
+  uint64_t start;
+  uint64_t duration;
+};
+
+// NOTE: owned by the registry so the events survive the thread exiting.
+struct thread_events_t {
+  uint32_t tid;
+  std::mutex mutex;
+  std::vector<event_t> events;
+};
+
+static std::atomic<bool> s_enabled{false};
+static std::mutex s_registry_mutex;
+static std::vector<std::shared_ptr<thread_events_t>> s_registry;
+static const auto s_epoch = std::chrono::steady_clock::now();
+
+static
+uint64_t
+now_ns()
+{
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - s_epoch).count();
+}
+
+static
+thread_events_t&
+get_thread_events()
+{
+  thread_local std::shared_ptr<thread_events_t> events;
+  if (!events) {
+    events = std::make_shared<thread_events_t>();
+    std::lock_guard<std::mutex> lock(s_registry_mutex);
+    events->tid = (uint32_t)s_registry.size();
+    s_registry.push_back(events);
+  }
+
+  return *events;
+}
+
+static
+void
+write_escaped(FILE* file, const char* str)
+{
+  for (; *str; ++str) {
+    unsigned char c = (unsigned char)*str;
+    if (c == '"' || c == '\\')
+      fprintf(file, "\\%c", c);
+    else if (c < 0x20)
+      fprintf(file, "\\u%04x", c);
+    else
+      fputc(c, file);
+  }
+}
+
+void
+enable()
+{
+  s_enabled.store(true);
+}
+
+bool
+is_enabled()
+{
+  return s_enabled.load(std::memory_order_relaxed);
+}
+
+bool
+write(const std::string& path)
+{
+  FILE* file = fopen(path.c_str(), "w");
+  if (!file)
+    return false;
+
+  std::vector<std::shared_ptr<thread_events_t>> registry;
+  {
+    std::lock_guard<std::mutex> lock(s_registry_mutex);
+    registry = s_registry;
+  }
+
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool first = true;
+  for (auto& thread : registry) {
+    fprintf(
+      file,
+      "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+      "\"args\":{\"name\":\"thread %u\"}}",
+      first ? "" : ",\n", thread->tid, thread->tid);
+    first = false;
+
+    std::lock_guard<std::mutex> lock(thread->mutex);
+    for (auto& event : thread->events) {
+      fprintf(file, ",\n{\"name\":\"");
+      write_escaped(file, event.name);
+      fprintf(
+        file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+        thread->tid, event.start / 1000.0, event.duration / 1000.0);
+      if (event.detail.size()) {
+        fprintf(file, ",\"args\":{\"detail\":\"");
+        write_escaped(file, event.detail.c_str());
+        fprintf(file, "\"}");
+      }
+      fprintf(file, "}");
+    }
+  }
+  fprintf(file, "\n]}\n");
+
+  fclose(file);
+  return true;
+}
+
+void
+clear()
+{
+  std::vector<std::shared_ptr<thread_events_t>> registry;
+  {
+    std::lock_guard<std::mutex> lock(s_registry_mutex);
+    registry = s_registry;
+  }
+
+  for (auto& thread : registry) {
+    std::lock_guard<std::mutex> lock(thread->mutex);
+    thread->events.clear();
+    thread->events.shrink_to_fit();
+  }
+}
+
+scope_t::scope_t(const char* _name, std::string _detail)
+  : name{_name}
+  , previous_tag{allocators::set_tracking_tag(_name)}
+  , start{0}
+  , active{is_enabled()}
+{
+  if (active) {
+    detail = std::move(_detail);
+    start = now_ns();
+  }
+}
+
+scope_t::~scope_t()
+{
+  allocators::set_tracking_tag(previous_tag);
+  if (!active)
+    return;
+
+  uint64_t end = now_ns();
+  thread_events_t& events = get_thread_events();
+  std::lock_guard<std::mutex> lock(events.mutex);
+  events.events.push_back({ name, std::move(detail), start, end - start });
+}
+
+}
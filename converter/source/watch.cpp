@@ -0,0 +1,308 @@
+/**
+ * @file watch.cpp
+ * @author khalilhenoud@gmail.com
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <cstdio>
+#include <converter/watch.h>
+
+#if defined(__linux__)
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <unordered_map>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <assimp/Importer.hpp>
+#include <converter/batch.h>
+
+
+using clock_type_t = std::chrono::steady_clock;
+
+static constexpr uint32_t s_watch_mask =
+  IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF;
+
+static
+void
+add_watch(
+  int32_t inotify_fd,
+  const std::string& directory,
+  std::unordered_map<int32_t, std::string>& watched)
+{
+  int32_t wd = inotify_add_watch(inotify_fd, directory.c_str(), s_watch_mask);
+  if (wd < 0) {
+    printf("cannot watch '%s': %s\n", directory.c_str(), strerror(errno));
+    return;
+  }
+
+  watched[wd] = directory;
+}
+
+static
+void
+add_watch_recursive(
+  int32_t inotify_fd,
+  const std::string& directory,
+  std::unordered_map<int32_t, std::string>& watched)
+{
+  add_watch(inotify_fd, directory, watched);
+
+  std::error_code error;
+  for (const auto& entry :
+    std::filesystem::recursive_directory_iterator(directory, error)) {
+    if (entry.is_directory())
+      add_watch(inotify_fd, entry.path().string(), watched);
+  }
+}
+
+// events were dropped, watch any directory created meanwhile and queue every
+// scene file, the cache skips the ones that did not change.
+static
+void
+rescan(
+  int32_t inotify_fd,
+  const std::vector<std::string>& directories,
+  std::unordered_map<int32_t, std::string>& watched,
+  const Assimp::Importer& importer,
+  std::map<std::string, clock_type_t::time_point>& pending,
+  clock_type_t::time_point deadline)
+{
+  // a directory already watched keeps its descriptor, deleted ones drop out.
+  watched.clear();
+  for (auto& directory : directories) {
+    add_watch_recursive(inotify_fd, directory, watched);
+
+    std::error_code error;
+    for (const auto& entry :
+      std::filesystem::recursive_directory_iterator(directory, error)) {
+      std::string path = entry.path().string();
+      if (entry.is_regular_file() && is_scene_file(importer, path))
+        pending[path] = deadline;
+    }
+  }
+}
+
+static
+int32_t
+open_socket(const std::string& socket_path)
+{
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    printf("socket path too long '%s'\n", socket_path.c_str());
+    return -1;
+  }
+  strcpy(address.sun_path, socket_path.c_str());
+
+  int32_t fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (fd < 0)
+    return -1;
+
+  unlink(socket_path.c_str());
+  if (
+    bind(fd, (sockaddr*)&address, sizeof(address)) < 0 ||
+    listen(fd, 8) < 0) {
+    printf("cannot listen on '%s': %s\n", socket_path.c_str(), strerror(errno));
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+int
+run_watch(
+  const std::vector<std::string>& directories,
+  const std::string& socket_path,
+  uint32_t debounce_ms,
+  const convert_fn_t& convert)
+{
+  int32_t inotify_fd = inotify_init1(IN_NONBLOCK);
+  if (inotify_fd < 0) {
+    printf("inotify_init1 failed: %s\n", strerror(errno));
+    return 1;
+  }
+
+  std::unordered_map<int32_t, std::string> watched;
+  for (auto& directory : directories)
+    add_watch_recursive(inotify_fd, directory, watched);
+
+  int32_t listen_fd = -1;
+  if (!socket_path.empty()) {
+    listen_fd = open_socket(socket_path);
+    if (listen_fd < 0) {
+      close(inotify_fd);
+      return 1;
+    }
+  }
+
+  // only used to recognize scene files by extension.
+  Assimp::Importer importer;
+  std::vector<int32_t> clients;
+  // path to the time it becomes eligible, ordered for deterministic output.
+  std::map<std::string, clock_type_t::time_point> pending;
+  const auto debounce = std::chrono::milliseconds(debounce_ms);
+
+  printf("watching %zu directories\n", watched.size());
+  fflush(stdout);
+
+  while (true) {
+    std::vector<pollfd> fds;
+    fds.push_back({ inotify_fd, POLLIN, 0 });
+    if (listen_fd >= 0)
+      fds.push_back({ listen_fd, POLLIN, 0 });
+    for (int32_t client : clients)
+      fds.push_back({ client, POLLIN, 0 });
+
+    int32_t timeout = -1;
+    auto now = clock_type_t::now();
+    for (auto& entry : pending) {
+      auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        entry.second - now).count();
+      left = left < 0 ? 0 : left;
+      timeout = timeout < 0 ? (int32_t)left : std::min(timeout, (int32_t)left);
+    }
+
+    if (poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR)
+      break;
+
+    if (fds[0].revents & POLLIN) {
+      alignas(inotify_event) char buffer[16 * 1024];
+      ssize_t length;
+      bool overflow = false;
+      while ((length = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char* ptr = buffer; ptr < buffer + length; ) {
+          inotify_event* event = (inotify_event*)ptr;
+          ptr += sizeof(inotify_event) + event->len;
+
+          if (event->mask & IN_Q_OVERFLOW) {
+            overflow = true;
+            continue;
+          }
+
+          if (event->mask & IN_DELETE_SELF) {
+            watched.erase(event->wd);
+            continue;
+          }
+
+          auto iter = watched.find(event->wd);
+          if (iter == watched.end() || event->len == 0)
+            continue;
+
+          std::string path = iter->second + "/" + event->name;
+          if (event->mask & IN_ISDIR) {
+            if (event->mask & (IN_CREATE | IN_MOVED_TO))
+              add_watch_recursive(inotify_fd, path, watched);
+            continue;
+          }
+
+          // IN_CREATE alone is followed by IN_CLOSE_WRITE, wait for it.
+          if (!(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)))
+            continue;
+
+          // editors save repeatedly, push the deadline on every write.
+          if (is_scene_file(importer, path))
+            pending[path] = clock_type_t::now() + debounce;
+        }
+      }
+
+      if (overflow) {
+        printf("\ninotify queue overflow, rescanning\n");
+        fflush(stdout);
+        rescan(
+          inotify_fd, directories, watched, importer, pending,
+          clock_type_t::now() + debounce);
+      }
+    }
+
+    if (listen_fd >= 0 && (fds[1].revents & POLLIN)) {
+      int32_t client;
+      while (
+        (client = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK)) >= 0)
+        clients.push_back(client);
+    }
+
+    {
+      // drop the clients that hung up, whatever they send is ignored.
+      size_t first_client = listen_fd >= 0 ? 2 : 1;
+      std::vector<int32_t> alive;
+      for (size_t i = first_client; i < fds.size(); ++i) {
+        bool closed = fds[i].revents & (POLLHUP | POLLERR);
+        if (fds[i].revents & POLLIN) {
+          char discard[256];
+          closed = closed || read(fds[i].fd, discard, sizeof(discard)) <= 0;
+        }
+
+        if (closed)
+          close(fds[i].fd);
+        else
+          alive.push_back(fds[i].fd);
+      }
+
+      // clients accepted during this iteration were not polled yet.
+      for (size_t i = fds.size() - first_client; i < clients.size(); ++i)
+        alive.push_back(clients[i]);
+      clients = alive;
+    }
+
+    now = clock_type_t::now();
+    for (auto iter = pending.begin(); iter != pending.end(); ) {
+      if (iter->second > now) {
+        ++iter;
+        continue;
+      }
+
+      std::string path = iter->first;
+      iter = pending.erase(iter);
+
+      auto start = clock_type_t::now();
+      bool success = convert(path.c_str());
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        clock_type_t::now() - start).count();
+
+      char message[1024];
+      snprintf(
+        message, sizeof(message), "%s %s in %lld ms\n",
+        success ? "converted" : "failed", path.c_str(), (long long)elapsed);
+      printf("\n%s", message);
+      fflush(stdout);
+
+      for (int32_t client : clients)
+        send(client, message, strlen(message), MSG_NOSIGNAL);
+    }
+  }
+
+  for (int32_t client : clients)
+    close(client);
+  if (listen_fd >= 0) {
+    close(listen_fd);
+    unlink(socket_path.c_str());
+  }
+  close(inotify_fd);
+  return 1;
+}
+
+#else
+
+int
+run_watch(
+  const std::vector<std::string>& directories,
+  const std::string& socket_path,
+  uint32_t debounce_ms,
+  const convert_fn_t& convert)
+{
+  printf("watch mode requires inotify, it is only available on linux.\n");
+  return 1;
+}
+
+#endif